@@ -0,0 +1,84 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+class Gas;
+namespace Garfield {
+    class MediumMagboltz;
+}
+
+/// Simulation settings which give different tables for the same mixture and electric field values
+struct GenerationOptions {
+    bool thermalMotion = true;
+    /// Fraction of excitations transferred to ionisation (Penning transfer), 0 disables it
+    double penningTransferRate = 0;
+
+    /// Used in file names to tell variants apart (e.g. 'thermalOff-penning0.3')
+    std::string GetSuffix() const;
+    /// Options of a file name containing a suffix (e.g. 'argon-thermalOff-penning0.3.gas'), empty if there is none
+    static std::optional<GenerationOptions> FromFilename(const std::string& filename);
+
+    bool operator==(const GenerationOptions& other) const;
+    bool operator!=(const GenerationOptions& other) const { return !(*this == other); }
+};
+
+void to_json(nlohmann::json& j, const GenerationOptions& options);
+void from_json(const nlohmann::json& j, GenerationOptions& options);
+
+/// All combinations of the given values (an empty list keeps the default value of the option)
+std::vector<GenerationOptions> generationVariants(const std::vector<bool>& thermalMotion, const std::vector<double>& penningTransferRates);
+
+/// Fills the gas table of a 'Gas' for a set of electric field values ('Gas::Generate' delegates to its backend)
+class GenerationBackend {
+protected:
+    GenerationOptions options;
+
+    /// Medium of the gas to generate into ('Gas::Generate' refreshes its table afterwards)
+    static Garfield::MediumMagboltz& GetMedium(Gas& gas);
+
+public:
+    virtual ~GenerationBackend() = default;
+
+    const GenerationOptions& GetOptions() const { return options; }
+    void SetOptions(const GenerationOptions& generationOptions) { options = generationOptions; }
+
+    virtual std::string GetName() const = 0;
+    /// Electric field values are sorted. The gas table is replaced by the generated one
+    virtual void Generate(Gas& gas, const std::vector<double>& electricFieldValues, unsigned int numberOfCollisions, bool verbose) = 0;
+    /// Adjusts the Townsend coefficient of a table generated without Penning transfer to 'rate', without simulating
+    /// again. Returns false if the table cannot be adjusted
+    virtual bool ApplyPenningTransfer(Gas& gas, double rate) = 0;
+};
+
+/// Garfield / Magboltz simulation (default)
+class MagboltzBackend : public GenerationBackend {
+public:
+    std::string GetName() const override { return "magboltz"; }
+    void Generate(Gas& gas, const std::vector<double>& electricFieldValues, unsigned int numberOfCollisions, bool verbose) override;
+    /// Garfield adjusts the Townsend coefficient with the excitation and ionisation rates stored in the table
+    bool ApplyPenningTransfer(Gas& gas, double rate) override;
+};
+
+/// Deterministic analytic transport curves (not physical), used to exercise everything around Magboltz quickly.
+/// Disabling thermal motion lowers the diffusion and Penning transfer raises the Townsend coefficient
+class SyntheticBackend : public GenerationBackend {
+protected:
+    double latency;
+    double noise;
+    unsigned int seed;
+
+public:
+    /// 'latency' in seconds per electric field value, 'noise' is the relative (gaussian) noise added to every value.
+    /// Noise only depends on the seed and the electric field value, so results do not depend on how points are split.
+    /// Throws std::runtime_error if 'latency' or 'noise' is negative
+    SyntheticBackend(double latency = 0, double noise = 0, unsigned int seed = 0);
+
+    std::string GetName() const override { return "synthetic"; }
+    void Generate(Gas& gas, const std::vector<double>& electricFieldValues, unsigned int numberOfCollisions, bool verbose) override;
+    bool ApplyPenningTransfer(Gas& gas, double rate) override;
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Backend.h"
+#include "nlohmann/json.hpp"
+
+class Gas;
+
+/// Index of a directory of gas files, so tables can be selected without loading every file
+namespace catalog {
+    /// Name of the index file, written at the top of the indexed directory
+    const std::string indexFilename = "gas-catalog.json";
+
+    struct Entry {
+        /// Gas file location relative to the indexed directory
+        std::string file;
+        /// Sorted by name (fractions in the same order)
+        std::vector<std::string> components;
+        std::vector<double> fractions;
+        /// Temperature in Celsius
+        double temperature = 0;
+        /// Pressure in bar
+        double pressure = 0;
+        /// Electric field range in V/cm
+        double electricFieldMin = 0;
+        double electricFieldMax = 0;
+        size_t numberOfElectricFieldValues = 0;
+        /// Number of collisions as encoded in the file name ('-nColl<n>'), 0 if unknown
+        unsigned int numberOfCollisions = 0;
+        /// Thermal motion and Penning transfer rate, from the file name suffix or the 'provenance' of the json file
+        /// saved next to the gas file (defaults if neither is found)
+        GenerationOptions options;
+        /// Used to reuse entries of unchanged files when rebuilding the index
+        uintmax_t fileSize = 0;
+        int64_t fileModified = 0;
+    };
+
+    void to_json(nlohmann::json& j, const Entry& entry);
+    void from_json(const nlohmann::json& j, Entry& entry);
+
+    struct Query {
+        std::vector<std::pair<std::string, double>> components;
+        double temperature = 20.0;
+        double pressure = 1.0;
+        /// Only entries generated with the same options match
+        GenerationOptions options;
+    };
+
+    /// Index all gas files under 'directory' (recursively). Entries of 'previous' are reused for unchanged files
+    std::vector<Entry> build(const std::filesystem::path& directory, const std::vector<Entry>& previous = {}, bool verbose = false);
+
+    bool write(const std::filesystem::path& indexFile, const std::vector<Entry>& entries);
+    std::optional<std::vector<Entry>> read(const std::filesystem::path& indexFile);
+
+    /// Number of collisions from the file name convention used by 'gas-cli generate' ('-nColl<n>'), 0 if not found
+    unsigned int numberOfCollisionsFromFilename(const std::string& filename);
+
+    /// Options of the gas file at 'path': file name suffix, then 'provenance' of '<path>.json', then defaults
+    GenerationOptions generationOptionsOfFile(const std::filesystem::path& path);
+
+    /// Distance between a catalog entry and a query, infinite if the component names or the generation options differ. Zero means an exact match.
+    /// Units: 1% of fraction, 10 Celsius and 10% of pressure all count as one
+    double distance(const Entry& entry, const Query& query);
+
+    /// Up to 'count' entries sorted by increasing distance (entries with different components or options are not included)
+    std::vector<std::pair<double, const Entry*>> nearest(const std::vector<Entry>& entries, const Query& query, size_t count);
+
+    struct Bracket {
+        /// 'a' is the entry closest to the query
+        const Entry* a = nullptr;
+        const Entry* b = nullptr;
+        /// Weight of 'b' for linear interpolation (0 gives 'a', 1 gives 'b')
+        double weight = 0;
+        /// Distance (same units as 'distance') between the query and the segment from 'a' to 'b'
+        double offLineDistance = 0;
+    };
+
+    /// Closest pair of entries with the query between them, on the segment joining them within 'tolerance' (same units
+    /// as 'distance'). Interpolation only makes sense along that segment. No value if there is no such pair
+    std::optional<Bracket> bracket(const std::vector<Entry>& entries, const Query& query, double tolerance = 0.1);
+
+    /// Gas properties (same keys as 'Gas::GetGasPropertiesJson', without the gas description) linearly interpolated
+    /// between two gases at the same electric field. 'weight' is the weight of 'b' (0 gives 'a', 1 gives 'b').
+    /// Both gases should be set to the pressure of the query first (properties depend on E/p, Garfield rescales them)
+    nlohmann::json interpolate(const Gas& a, const Gas& b, double weight, const std::vector<double>& electricField);
+} // namespace catalog
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+
+class Gas;
+
+namespace exporter {
+    /// Valid C++ identifier from a gas name ("Ar_98-C4H10_2" -> "gas_Ar_98_C4H10_2")
+    std::string identifier(const std::string& name);
+
+    /// C++ header with the gas table as constexpr arrays (electric field and every transport property), metadata and
+    /// interpolation functions (see 'TableInterpolation.h'). Everything is placed in namespace 'namespaceName'
+    std::string cppHeader(const Gas& gas, const std::string& namespaceName, const std::string& source = "");
+} // namespace exporter
@@ -2,22 +2,59 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include "Garfield/MediumMagboltz.hh"
 #include "nlohmann/json.hpp"
 
+#include "Backend.h"
+#include "Span.h"
+
+/// Electron transport table on the electric field grid of a gas file (same units as the 'Gas' getters)
+struct GasTable {
+    std::vector<double> electricField;
+    std::vector<double> electronDriftVelocity;
+    std::vector<double> electronTransversalDiffusion;
+    std::vector<double> electronLongitudinalDiffusion;
+    std::vector<double> electronTownsend;
+    std::vector<double> electronAttachment;
+
+    /// Transport properties paired with the key used for them in the gas properties json
+    std::vector<std::pair<std::string, std::vector<double>*>> GetProperties();
+    std::vector<std::pair<std::string, const std::vector<double>*>> GetProperties() const;
+};
+
 class Gas {
 
 protected:
     std::unique_ptr<Garfield::MediumMagboltz> gas;
+    /// Copy of the garfield table, refreshed whenever the table changes (load, generate, merge, set)
+    GasTable table;
+    std::shared_ptr<GenerationBackend> backend = std::make_shared<MagboltzBackend>();
+
+    void UpdateTable();
+    /// Changes to the medium are not reflected in the cached table, only backends (which refresh it) can change it
+    Garfield::MediumMagboltz& GetMedium() { return *gas; }
+    friend class GenerationBackend;
+    /// Empty string if components are valid, otherwise the reason they are not
+    static std::string ValidateComponents(const std::vector<std::pair<std::string, double>>& components);
 
 public:
     Gas();
+    /// Throws std::runtime_error if the gas file cannot be loaded (see 'FromFile' for an error returning alternative)
     Gas(const std::string& gasFilepath);
+    /// Throws std::runtime_error if components are not valid (see 'FromComponents' for an error returning alternative)
     Gas(std::vector<std::pair<std::string, double>> components);
 
+    /// Returns no value (and fills 'error' if given) if the gas file cannot be loaded
+    static std::optional<Gas> FromFile(const std::string& gasFilepath, std::string* error = nullptr);
+    /// Returns no value (and fills 'error' if given) if components are not valid
+    static std::optional<Gas> FromComponents(std::vector<std::pair<std::string, double>> components, std::string* error = nullptr);
+
+    const Garfield::MediumMagboltz& GetMedium() const { return *gas; }
+
     std::string GetName() const;
     std::string GetGarfieldName() const;
 
@@ -44,12 +81,42 @@ public:
     /// Attachment coefficient (cm-1)
     double GetElectronAttachment(double electricField) const;
 
+    /// Values stored in the gas table (first magnetic field and angle entry). No interpolation is involved
+    const GasTable& GetTable() const { return table; }
+
+    /// Views into the values stored in the gas table, valid until the table changes (Generate, Merge, SetTable)
+    tools::span<const double> GetTableElectricFieldView() const { return table.electricField; }
+    tools::span<const double> GetTableElectronDriftVelocityView() const { return table.electronDriftVelocity; }
+    tools::span<const double> GetTableElectronTransversalDiffusionView() const { return table.electronTransversalDiffusion; }
+    tools::span<const double> GetTableElectronLongitudinalDiffusionView() const { return table.electronLongitudinalDiffusion; }
+    tools::span<const double> GetTableElectronTownsendView() const { return table.electronTownsend; }
+    tools::span<const double> GetTableElectronAttachmentView() const { return table.electronAttachment; }
+
+    /// Tables of the gas file which 'GasTable' does not hold (e.g. ion mobility, excitation rates), lost by 'SetTable'
+    std::vector<std::string> GetTablesNotInGasTable() const;
+
+    /// Replace the gas table (and field grid) by the given one. Properties which are zero everywhere are left empty.
+    /// Every other table is discarded (see 'GetTablesNotInGasTable'), with a warning
+    bool SetTable(const GasTable& table);
+    /// Same gas keeping only the electric field values at 'indices' (ascending) of the table, in every table of the gas
+    /// file (unlike 'SetTable'). No value if the gas file cannot be rewritten
+    std::optional<Gas> SelectElectricFieldValues(const std::vector<size_t>& indices) const;
+    /// Transport properties at 'electricField' values as read by users of the gas file (Garfield interpolation)
+    GasTable GetInterpolatedTable(const std::vector<double>& electricField) const;
+
     void SetPressure(double pressureInBar);
     void SetTemperature(double temperatureInCelsius);
 
+    const GenerationBackend& GetBackend() const { return *backend; }
+    void SetBackend(std::shared_ptr<GenerationBackend> generationBackend) { backend = std::move(generationBackend); }
+
     void Generate(std::vector<double> electricFieldValues, unsigned int numberOfCollisions = 10, bool verbose = false);
-    void Write(const std::string& filename) const;
+    /// Penning transfer for a table generated without it, only the Townsend coefficient changes (no simulation).
+    /// Returns false if the backend cannot adjust the table
+    bool ApplyPenningTransfer(double rate);
+    bool Write(const std::string& filename) const;
     bool Merge(const std::string& gasFile, bool replaceOld = false);
 
+    /// Throws std::runtime_error if none of the requested electric field values is inside the range of the table
     nlohmann::json GetGasPropertiesJson(const std::vector<double>& electricField = {}) const;
 };
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/// Sampling profiler for production runs (where 'perf' may not be available). The thread calling 'start' is
+/// interrupted periodically (SIGPROF, on its CPU time) and its stack is recorded with 'backtrace'. Only one profiler
+/// can run per process. Forked processes are not sampled
+namespace profiler {
+    /// Start sampling the calling thread at 'frequency' samples per CPU second. Returns false if already running or
+    /// if the timer could not be created
+    bool start(double frequency = 99);
+
+    /// Stop sampling, the samples recorded so far are kept until the next 'start'
+    void stop();
+
+    bool isRunning();
+
+    /// Number of recorded samples and of samples lost because the buffer was full
+    size_t samples();
+    size_t droppedSamples();
+
+    /// Fraction of the sampled CPU time spent recording samples
+    double overhead();
+
+    /// One line per distinct stack: 'root;caller;...;leaf <count>' (input of flamegraph.pl, speedscope, ...)
+    std::string foldedStacks();
+
+    /// Table of the 'count' symbols with the most samples: self (symbol at the top of the stack) and total
+    std::string summary(size_t count = 25);
+} // namespace profiler
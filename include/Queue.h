@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+/// Work queue on a (shared) filesystem directory. Tasks are json files which move between subdirectories:
+/// 'pending' -> 'claimed' -> 'done' (or 'failed' after too many failed attempts). Claims are atomic renames, so any number of workers (on any number of nodes)
+/// can process the same queue. The claimed file name holds a token of its owner: a worker whose task was claimed
+/// again by another one can no longer refresh, complete or release it. Workers refresh the modification time of their claimed task periodically (lease),
+/// claimed tasks not refreshed within the lease are moved back to 'pending'. Task ids are reserved by exclusive
+/// creation in 'ids', so any number of processes can enqueue into the same queue.
+namespace workqueue {
+    struct Task {
+        std::string id;
+        /// Claim token ('<worker>-<random>'), set by 'claim'
+        std::string owner;
+        nlohmann::json parameters;
+        /// Number of earlier attempts that failed (see 'fail')
+        unsigned int attempts = 0;
+    };
+
+    /// Create the queue layout (if needed) and add one pending task per entry. Returns the ids of the new tasks
+    std::vector<std::string> enqueue(const std::filesystem::path& queue, const std::vector<nlohmann::json>& tasks);
+
+    /// Claim the next pending task for 'worker' (name without '/'), no value if there are no pending tasks left
+    std::optional<Task> claim(const std::filesystem::path& queue, const std::string& worker);
+
+    /// Extend the lease of a claimed task. Returns false if the task is no longer claimed by this claim (e.g. its lease
+    /// expired)
+    bool heartbeat(const std::filesystem::path& queue, const Task& task);
+
+    /// Mark a claimed task as done. Returns false if the task is no longer claimed by this claim
+    bool complete(const std::filesystem::path& queue, const Task& task);
+
+    /// Return a claimed task to the pending tasks. Returns false if the task is no longer claimed by this claim
+    bool release(const std::filesystem::path& queue, const Task& task);
+
+    /// Count a failed attempt of a claimed task: it goes back to pending, or to 'failed' once 'maxAttempts' attempts
+    /// failed. Returns false if the task is no longer claimed by this claim
+    bool fail(const std::filesystem::path& queue, const Task& task, unsigned int maxAttempts);
+
+    /// Move claimed tasks whose lease expired back to pending. Returns the number of requeued tasks
+    size_t requeueExpired(const std::filesystem::path& queue, std::chrono::seconds lease);
+
+    size_t countPending(const std::filesystem::path& queue);
+    size_t countClaimed(const std::filesystem::path& queue);
+    size_t countDone(const std::filesystem::path& queue);
+    size_t countFailed(const std::filesystem::path& queue);
+
+    /// Location of the result (gas file) of a task
+    std::filesystem::path resultPath(const std::filesystem::path& queue, const Task& task);
+
+    /// Gas files of all the results written so far
+    std::vector<std::filesystem::path> results(const std::filesystem::path& queue);
+} // namespace workqueue
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace tools {
+    /// Minimal non-owning view over contiguous memory (std::span is C++20).
+    /// The same type for every language standard, so the library and its users agree on the functions returning it.
+    /// With C++20 it converts to std::span (contiguous range)
+    template<typename T>
+    class span {
+    public:
+        using element_type = T;
+        using iterator = T*;
+
+        constexpr span() noexcept = default;
+        constexpr span(T* data, std::size_t size) noexcept : pointer(data), length(size) {}
+        template<typename U, typename Allocator>
+        constexpr span(const std::vector<U, Allocator>& values) noexcept : pointer(values.data()), length(values.size()) {}
+        template<typename U, typename Allocator>
+        constexpr span(std::vector<U, Allocator>& values) noexcept : pointer(values.data()), length(values.size()) {}
+
+        constexpr T* data() const noexcept { return pointer; }
+        constexpr std::size_t size() const noexcept { return length; }
+        constexpr bool empty() const noexcept { return length == 0; }
+        constexpr T& operator[](std::size_t i) const { return pointer[i]; }
+        constexpr T& front() const { return pointer[0]; }
+        constexpr T& back() const { return pointer[length - 1]; }
+        constexpr iterator begin() const noexcept { return pointer; }
+        constexpr iterator end() const noexcept { return pointer + length; }
+
+    private:
+        T* pointer = nullptr;
+        std::size_t length = 0;
+    };
+} // namespace tools
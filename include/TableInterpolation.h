@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+
+/// Header-only helpers for gas tables exported as C++ headers ('gas-cli export --cpp-header').
+/// No dependencies (Garfield, ROOT) and usable in constant expressions
+namespace gastable {
+    /// Linear interpolation of 'values' at 'x' on the ascending 'grid'. Values outside the grid are clamped to the edges
+    template<std::size_t N>
+    constexpr double interpolate(const double (&grid)[N], const double (&values)[N], double x) {
+        static_assert(N > 0, "empty table");
+        if (N == 1 || x <= grid[0]) {
+            return values[0];
+        }
+        if (x >= grid[N - 1]) {
+            return values[N - 1];
+        }
+
+        std::size_t low = 0, high = N - 1;
+        while (high - low > 1) {
+            const std::size_t middle = (low + high) / 2;
+            if (grid[middle] <= x) {
+                low = middle;
+            } else {
+                high = middle;
+            }
+        }
+        return values[low] + (values[high] - values[low]) * (x - grid[low]) / (grid[high] - grid[low]);
+    }
+} // namespace gastable
@@ -3,7 +3,10 @@
 
 #include <algorithm>
 #include <cmath>
+#include <filesystem>
+#include <functional>
 #include <iostream>
+#include <optional>
 #include <regex>
 
 namespace tools {
@@ -38,9 +41,77 @@ namespace tools {
 
     bool similar(double a, double b, double eps = 1E-3);
 
+    /// Linear interpolation of the value at 'x' from points (x0, y0) and (x1, y1)
+    double interpolateLinear(double x0, double y0, double x1, double y1, double x);
+
+    /// Relative error of 'reconstructed' with respect to 'value' (same zero handling as 'similar')
+    double relativeError(double value, double reconstructed);
+
+    /// Indices of the points (x sorted ascending) that have to be kept so that every dropped point can be reconstructed,
+    /// by linear interpolation between its kept neighbours, within 'relTol' for all the series in 'ys'. First and last points are always kept
+    std::vector<size_t> compactIndices(const std::vector<double>& x, const std::vector<std::vector<double>>& ys, double relTol);
+
+    /// Maximum relative error when reconstructing 'y' from the points in 'keptIndices' only
+    double maxReconstructionError(const std::vector<double>& x, const std::vector<double>& y, const std::vector<size_t>& keptIndices);
+
+    /// Value of each point predicted by a quadratic least squares fit to its neighbours ('window' on each side, the point
+    /// itself and 'excluded' points are not used). Fit is done in log scale for x and/or y when all the values in the neighbourhood are positive,
+    /// zeros are not neighbours of a positive point.
+    /// Points without at least two neighbours keep their value
+    std::vector<double> localFitPrediction(const std::vector<double>& x, const std::vector<double>& y, unsigned int window = 3, const std::vector<bool>& excluded = {});
+
+    /// Indices of the points (x sorted ascending) deviating from the local fit of their neighbours by more than 'threshold'
+    /// robust standard deviations and by more than 'minRelativeDeviation'. The standard deviation is the larger of the
+    /// median absolute deviations of the residuals of the other points, over the whole table and next to the point, fitted
+    /// without it. Points fitted on one side only (edges, non positive x), runs of zeros (e.g. below a threshold) and the
+    /// first 'window' points next to them are never flagged
+    std::vector<size_t> findOutliers(const std::vector<double>& x, const std::vector<double>& y, unsigned int window = 3, double threshold = 5, double minRelativeDeviation = 1E-2);
+
+    /// Run 'task(i)' for every i in [0, count) in child processes (fork), at most 'jobs' at the same time.
+    /// Returns the indices of the tasks which failed (non zero return value, exception or crash)
+    std::vector<size_t> forkEach(size_t count, unsigned int jobs, const std::function<int(size_t)>& task);
+
     /// Write contents (string) to file
     void writeToFile(const std::string& filename, const std::string& content);
 
+    /// Read the whole contents of a file or stream
+    std::string readFile(const std::string& filename);
+    std::string readStream(std::istream& stream);
+
+    /// Path used by the user to mean standard input / output
+    inline bool isStandardStream(const std::filesystem::path& path) { return path == "-"; }
+
+    /// Reserve standard output for data: from now on anything written to standard output (including messages from
+    /// Garfield / Magboltz) goes to standard error. Returns the file descriptor to write data into
+    int reserveStandardOutput();
+
+    /// Write contents (string) to a file descriptor
+    bool writeToFileDescriptor(int fileDescriptor, const std::string& content);
+
+    /// Split the contents of concatenated gas files (as produced by piping several outputs together)
+    std::vector<std::string> splitGasFiles(const std::string& content);
+
+    /// Gas file (Garfield format) keeping only the electric field values at 'indices' (ascending) in every table that
+    /// depends on the field: transport properties, excitation and ionisation rates, ion mobility, ... No value if the
+    /// content cannot be parsed
+    std::optional<std::string> selectGasFileElectricFieldValues(const std::string& content, const std::vector<size_t>& indices);
+
+    /// Unique file in the (local) temporary directory, removed when the object is destroyed.
+    /// Garfield reads and writes gas files by path, so streamed gas files go through these
+    class TemporaryFile {
+        std::filesystem::path path;
+
+    public:
+        explicit TemporaryFile(const std::string& content = "");
+        ~TemporaryFile();
+        TemporaryFile(const TemporaryFile&) = delete;
+        TemporaryFile& operator=(const TemporaryFile&) = delete;
+        TemporaryFile(TemporaryFile&& other) noexcept;
+        TemporaryFile& operator=(TemporaryFile&& other) noexcept;
+
+        const std::filesystem::path& GetPath() const { return path; }
+    };
+
     /// Compress files using tar (tar needs to be available to work)
     void tar(const std::string& filename, const std::vector<std::string>& files);
 } // namespace tools
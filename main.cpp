@@ -1,12 +1,21 @@
 
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
 #include <regex>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
 
 #include "CLI/App.hpp"
 #include "CLI/Config.hpp"
 #include "CLI/Formatter.hpp"
 
+#include "Catalog.h"
+#include "Export.h"
 #include "Gas.h"
+#include "Profiler.h"
+#include "Queue.h"
 #include "Tools.h"
 
 using namespace std;
@@ -22,33 +31,124 @@ int main(int argc, char** argv) {
     fs::path outputDirectory;
     fs::path gasPropertiesJsonFilename;
 
+    fs::path profileFilename;
+    app.add_option("--profile", profileFilename, "Sample the stack of the main thread and save '<location>.folded' (folded stacks for flame graphs) and '<location>.txt' (top symbols) on exit. Must be given before the subcommand. If location not specified 'gas-cli-profile-<pid>' in the output directory is used")->expected(0, 1);
+    double profileFrequency = 99;
+    app.add_option("--profile-frequency", profileFrequency, "Samples per second of CPU time of the profiler (defaults to 99)");
+
     CLI::App* read = app.add_subcommand("read", "Read from a gas file properties such as drift velocity of diffusion coefficients and generate a JSON file with the results");
-    read->add_option("-g,--gas,-i,--input", gasFilenameInput, "Garfield gas file (.gas) read from")->required();
-    read->add_option("-o,--output,--json", gasPropertiesJsonFilename, "Location to save gas properties as json file. If location not specified it will auto generate it")->expected(0, 1);
+    read->add_option("-g,--gas,-i,--input", gasFilenameInput, "Garfield gas file (.gas) read from ('-' for standard input)")->required();
+    read->add_option("-o,--output,--json", gasPropertiesJsonFilename, "Location to save gas properties as json file ('-' for standard output). If location not specified it will auto generate it")->expected(0, 1);
+    string readFormat = "json";
+    read->add_option("--format", readFormat, "Format of the gas properties: 'json', 'cbor', 'msgpack', 'bson' or 'ubjson' (defaults to 'json'). Binary formats are written to standard output if no location is given")->check(CLI::IsMember({"json", "cbor", "msgpack", "bson", "ubjson"}));
     read->add_option("--dir,--output-dir,--output-directory", outputDirectory, "Directory to save json file into")->expected(1);
 
     CLI::App* generate = app.add_subcommand("generate", "Generate a Garfield gas file using command line parameters");
-    generate->add_option("-g,--gas,-o,--output", gasFilenameOutput, "Garfield gas file (.gas) to save output into");
+    generate->add_option("-g,--gas,-o,--output", gasFilenameOutput, "Garfield gas file (.gas) to save output into ('-' for standard output)");
     generate->add_option("--dir,--output-dir,--output-directory", outputDirectory, "Directory to save gas file into")->expected(1);
     generate->add_option("--json", gasPropertiesJsonFilename, "Location to save gas properties as json file. If location not specified it will auto generate it")->expected(0, 1);
-    vector<string> generateGasComponentsString;
-    generate->add_option("--components,--mixture", generateGasComponentsString, "Garfield gas components to use in the gas file. It should be of the form of 'component1', 'fraction1', 'component2', 'fraction2', ... up to 6 components")->required()->expected(1, 12);
-    double pressure = 1.0, temperature = 20.0;
-    generate->add_option("--pressure", pressure, "Gas pressure in bar");
-    generate->add_option("--temperature,--temp", temperature, "Gas temperature in Celsius");
-    unsigned int numberOfCollisions = 10;
-    generate->add_option("--collisions,--ncoll,--nColl", numberOfCollisions, "Number of collisions to simulate (defaults to 10)");
     bool generateVerbose = false;
     generate->add_flag("-v,--verbose", generateVerbose, "Garfield verbosity");
     bool generateProgress = true;
     generate->add_flag("--progress,!--no-progress", generateProgress, "Save progress periodically to output file (defaults to true)");
     bool generatePrint = false;
     generate->add_flag("--print", generatePrint, "Print gas properties to stdout after generating gas file (defaults to false)");
+    vector<string> generateVariants;
+    generate->add_option("--variants", generateVariants, "Generate one table per combination of simulation settings, e.g. 'thermal=on,off' or 'penning=0.3,0.5'. Each variant is saved as '<output>-<variant>.gas' with a json file including its settings");
+    vector<double> generatePenningRates;
+    generate->add_option("--penning", generatePenningRates, "Penning transfer rates to generate variants for (same as '--variants penning=<r1>,<r2>')")->delimiter(',')->check(CLI::Range(0.0, 1.0));
+
+    CLI::App* enqueue = app.add_subcommand("enqueue", "Add one task per electric field value to a work queue directory (to be processed by 'worker' subcommands)");
+    fs::path queueDirectory;
+    enqueue->add_option("--queue", queueDirectory, "Queue directory (on a filesystem shared by all workers)")->required();
+
+    CLI::App* worker = app.add_subcommand("worker", "Process tasks from a work queue directory until there are no tasks left. Any number of workers can process the same queue");
+    worker->add_option("--queue", queueDirectory, "Queue directory (on a filesystem shared by all workers)")->required()->check(CLI::ExistingDirectory);
+    unsigned int workerLeaseSeconds = 600;
+    worker->add_option("--lease", workerLeaseSeconds, "Seconds without heartbeat after which a claimed task is considered abandoned and processed again (defaults to 600)");
+    unsigned int workerPollSeconds = 30;
+    worker->add_option("--poll", workerPollSeconds, "Seconds to wait before checking again for abandoned tasks while other workers are busy (defaults to 30)");
+    unsigned int workerMaxAttempts = 3;
+    worker->add_option("--max-attempts", workerMaxAttempts, "Failed attempts after which a task is moved to the failed tasks of the queue instead of being processed again (defaults to 3)")->check(CLI::PositiveNumber);
+    bool workerVerbose = false;
+    worker->add_flag("-v,--verbose", workerVerbose, "Garfield verbosity");
+
+    CLI::App* catalogSubcommand = app.add_subcommand("catalog", "Index a directory of gas files and select tables using the index");
+    catalogSubcommand->require_subcommand(1);
+    fs::path catalogDirectory;
+    CLI::App* catalogBuild = catalogSubcommand->add_subcommand("build", "Index all gas files in a directory (recursively). The index is saved as '" + catalog::indexFilename + "' in the directory");
+    catalogBuild->add_option("directory", catalogDirectory, "Directory containing gas files")->required()->check(CLI::ExistingDirectory);
+    bool catalogVerbose = false;
+    catalogBuild->add_flag("-v,--verbose", catalogVerbose, "Print every file that gets indexed");
+    CLI::App* catalogQuery = catalogSubcommand->add_subcommand("query", "Find the indexed tables closest to a gas mixture, temperature and pressure");
+    catalogQuery->add_option("directory", catalogDirectory, "Indexed directory (or its index file)")->required();
+    size_t catalogQueryCount = 5;
+    catalogQuery->add_option("-n,--count", catalogQueryCount, "Maximum number of tables to list (defaults to 5)");
+    bool catalogInterpolate = false;
+    catalogQuery->add_flag("--interpolate", catalogInterpolate, "Linearly interpolate gas properties between the tables bracketing the query (if there is no exact match)");
+    double catalogInterpolationTolerance = 0.1;
+    catalogQuery->add_option("--interpolation-tolerance", catalogInterpolationTolerance, "Maximum distance between the query and the segment joining the bracketing tables (1% of fraction, 10 Celsius and 10% of pressure all count as one) (defaults to 0.1)");
+    catalogQuery->add_option("--json,-o,--output", gasPropertiesJsonFilename, "Location to save gas properties (exact match or interpolation) as json file ('-' for standard output). If not specified they are printed");
+
+    CLI::App* repair = app.add_subcommand("repair", "Detect outliers (and zeroed values) of the transport properties with respect to a local fit of their neighbours and generate them again with more collisions");
+    repair->add_option("-g,--gas,-i,--input", gasFilenameInput, "Garfield gas file (.gas) to repair")->required();
+    repair->add_option("-o,--output", gasFilenameOutput, "Garfield gas file (.gas) to save output into. If not specified '<input>-repaired.gas' will be used");
+    repair->add_option("--dir,--output-dir,--output-directory", outputDirectory, "Directory to save repaired gas file into")->expected(1);
+    unsigned int repairCollisions = 0;
+    repair->add_option("--collisions,--ncoll,--nColl", repairCollisions, "Number of collisions for the values generated again (defaults to 10 times the number in the input file name '-nColl<n>', or 100 if not found)");
+    unsigned int repairWindow = 3;
+    repair->add_option("--window", repairWindow, "Number of neighbours on each side used for the local fit (defaults to 3)");
+    double repairThreshold = 5;
+    repair->add_option("--threshold", repairThreshold, "Deviation from the local fit, in robust standard deviations, above which a value is an outlier (defaults to 5)");
+    bool repairReportOnly = false;
+    repair->add_flag("--report-only,--dry-run", repairReportOnly, "Only report outliers, do not generate them again");
+    bool repairVerbose = false;
+    repair->add_flag("-v,--verbose", repairVerbose, "Garfield verbosity");
+
+    CLI::App* exportSubcommand = app.add_subcommand("export", "Export a gas table into other formats");
+    exportSubcommand->add_option("-g,--gas,-i,--input", gasFilenameInput, "Garfield gas file (.gas) to export")->required();
+    fs::path exportCppHeaderFilename;
+    exportSubcommand->add_option("--cpp-header", exportCppHeaderFilename, "C++ header with the table as constexpr arrays and interpolation functions (needs 'TableInterpolation.h', no Garfield or ROOT). '-' for standard output")->required();
+    string exportNamespace;
+    exportSubcommand->add_option("--namespace", exportNamespace, "Namespace of the exported table (defaults to 'gas_' followed by the gas name)");
+    exportSubcommand->add_option("--dir,--output-dir,--output-directory", outputDirectory, "Directory to save exported files into")->expected(1);
+
+    vector<string> generateGasComponentsString;
+    double pressure = 1.0, temperature = 20.0;
+    unsigned int numberOfCollisions = 10;
+    for (CLI::App* subcommand: {generate, enqueue}) {
+        subcommand->add_option("--collisions,--ncoll,--nColl", numberOfCollisions, "Number of collisions to simulate (defaults to 10)");
+    }
+
+    string backendName = "magboltz";
+    double syntheticLatency = 0, syntheticNoise = 0;
+    unsigned int syntheticSeed = 0;
+    unsigned int jobs = max(thread::hardware_concurrency(), 1U);
+    for (CLI::App* subcommand: {generate, repair}) {
+        subcommand->add_option("-j,--jobs", jobs, "Number of processes generating in parallel (defaults to number of cores)");
+    }
+    string thermalMotionOption;
+    double penningTransferRateOption = 0;
+    for (CLI::App* subcommand: {enqueue, repair, catalogQuery}) {
+        subcommand->add_option("--thermal", thermalMotionOption, "Thermal motion of the gas molecules: 'on' or 'off' (defaults to 'on', or to the variant in the input file name for 'repair')")->check(CLI::IsMember({"on", "off"}));
+        subcommand->add_option("--penning", penningTransferRateOption, "Penning transfer rate, 0 disables it (defaults to 0, or to the variant in the input file name for 'repair')")->check(CLI::Range(0.0, 1.0));
+    }
+    for (CLI::App* subcommand: {generate, worker, repair}) {
+        subcommand->add_option("--backend", backendName, "Generation backend: 'magboltz' or 'synthetic' (analytic curves, not physical, for testing) (defaults to 'magboltz')")->check(CLI::IsMember({"magboltz", "synthetic"}));
+        subcommand->add_option("--synthetic-latency", syntheticLatency, "Seconds spent per electric field value by the synthetic backend (defaults to 0)")->check(CLI::NonNegativeNumber);
+        subcommand->add_option("--synthetic-noise", syntheticNoise, "Relative noise added to every value by the synthetic backend (defaults to 0)")->check(CLI::NonNegativeNumber);
+        subcommand->add_option("--synthetic-seed", syntheticSeed, "Random seed of the synthetic backend (defaults to 0)");
+    }
+    for (CLI::App* subcommand: {generate, enqueue, catalogQuery}) {
+        subcommand->add_option("--components,--mixture", generateGasComponentsString, "Garfield gas components to use in the gas file. It should be of the form of 'component1', 'fraction1', 'component2', 'fraction2', ... up to 6 components")->required()->expected(1, 12);
+        subcommand->add_option("--pressure", pressure, "Gas pressure in bar");
+        subcommand->add_option("--temperature,--temp", temperature, "Gas temperature in Celsius");
+    }
 
     vector<double> subcommandGasElectricFieldValues;
     vector<double> subcommandGasElectricFieldLinearOptions;
     vector<double> subcommandGasElectricFieldLogOptions;
-    for (CLI::App* subcommand: {read, generate}) {
+    for (CLI::App* subcommand: {read, generate, enqueue, catalogQuery}) {
         subcommand->add_option("--electric-field,--field,--efield,-E,-e", subcommandGasElectricFieldValues, "Gas electric field values in V/cm");
         subcommand->add_option("--electric-field-linear,--electric-field-lin,--field-lin,--efield-lin,--E-lin,--e-lin", subcommandGasElectricFieldLinearOptions, "Use linearly spaced electric field values (start, end, number)")->expected(3);
         subcommand->add_option("--electric-field-log,--electric-field-log,--field-log,--efield-log,--E-log,--e-log", subcommandGasElectricFieldLogOptions, "Use logarithmically spaced electric field values (start, end, number)")->expected(3);
@@ -58,15 +158,23 @@ int main(int argc, char** argv) {
     generate->add_flag("--test", generateTestOnly, "Do not run generation (used to test input parameters)");
 
     CLI::App* merge = app.add_subcommand("merge", "Merge multiple Garfield gas files into one");
-    merge->add_option("-g,--gas,-o,--output", gasFilenameOutput, "Garfield gas file (.gas) to save output into")->required();
+    merge->add_option("-g,--gas,-o,--output", gasFilenameOutput, "Garfield gas file (.gas) to save output into ('-' for standard output)")->required();
     vector<fs::path> mergeGasInputFilenames;
-    merge->add_option("-i,--input", mergeGasInputFilenames, "Garfield gas file (.gas) to merge into the output. In case of overlaps, first file of list will take precedence")->required()->expected(2, numeric_limits<int>::max());
+    merge->add_option("-i,--input", mergeGasInputFilenames, "Garfield gas file (.gas) to merge into the output ('-' for standard input, which can contain several concatenated gas files). In case of overlaps, first file of list will take precedence")->expected(1, numeric_limits<int>::max());
+    merge->add_option("--queue", queueDirectory, "Also merge all the results of a work queue directory (after the input files)")->check(CLI::ExistingDirectory);
     merge->add_option("--dir,--output-dir,--output-directory", outputDirectory, "Directory to save merged gas file into")->expected(1);
     bool mergeVerbose = false;
     merge->add_flag("-v,--verbose", mergeVerbose, "Merge verbosity");
     bool mergeCompressOutput = false;
     merge->add_flag("--tar,--compress", mergeCompressOutput, "Compress output gas file using tar");
 
+    CLI::App* compact = app.add_subcommand("compact", "Remove electric field values which can be reconstructed from their neighbours within tolerance for all transport properties. Every table of the gas file is kept");
+    compact->add_option("-g,--gas,-i,--input", gasFilenameInput, "Garfield gas file (.gas) to compact")->required();
+    compact->add_option("-o,--output", gasFilenameOutput, "Garfield gas file (.gas) to save output into. If not specified '<input>-compact.gas' will be used");
+    compact->add_option("--dir,--output-dir,--output-directory", outputDirectory, "Directory to save compacted gas file into")->expected(1);
+    double compactRelativeTolerance = 1E-3;
+    compact->add_option("--rel-tol,--relative-tolerance", compactRelativeTolerance, "Maximum relative error allowed when reading a removed value from the compacted gas file (defaults to 1E-3)")->check(CLI::NonNegativeNumber);
+
     app.require_subcommand(1);
 
     CLI11_PARSE(app, argc, argv);
@@ -79,9 +187,111 @@ int main(int argc, char** argv) {
         outputDirectory = fs::current_path();
     }
 
+    // results are saved when the process exits (returning from main or calling exit), forked processes do not save them
+    static fs::path profileOutput;
+    if (!app.get_option("--profile")->empty()) {
+        profileOutput = profileFilename.empty() ? fs::path("gas-cli-profile-" + to_string(getpid())) : profileFilename;
+        if (!profileOutput.is_absolute()) {
+            profileOutput = outputDirectory / profileOutput;
+        }
+        if (!profiler::start(profileFrequency)) {
+            cerr << "Warning: profiler could not be started" << endl;
+        } else {
+            atexit([]() {
+                profiler::stop();
+                tools::writeToFile(profileOutput.string() + ".folded", profiler::foldedStacks());
+                tools::writeToFile(profileOutput.string() + ".txt", profiler::summary());
+                cerr << "Profile saved to " << profileOutput << " ('.folded' and '.txt', " << profiler::samples() << " samples)" << endl;
+            });
+        }
+    }
+
+    // '-' means standard input / output. Garfield reads and writes gas files by path, so streamed gas files go through
+    // local temporary files. When data is written to standard output, every message goes to standard error instead
+    const bool standardOutputIsData = tools::isStandardStream(gasFilenameOutput) || tools::isStandardStream(gasPropertiesJsonFilename) ||
+                                      tools::isStandardStream(exportCppHeaderFilename) || (read->parsed() && readFormat != "json" && read->get_option("--json")->empty());
+    if (tools::isStandardStream(gasFilenameOutput) && tools::isStandardStream(gasPropertiesJsonFilename)) {
+        cerr << "Gas file and gas properties cannot be both written to standard output" << endl;
+        return 1;
+    }
+    const int dataOutput = standardOutputIsData ? tools::reserveStandardOutput() : STDOUT_FILENO;
+
+    vector<tools::TemporaryFile> standardInputFiles;
+    bool standardInputRead = false;
+    auto readStandardInput = [&]() {
+        if (!standardInputRead) {
+            standardInputRead = true;
+            for (const auto& content: tools::splitGasFiles(tools::readStream(cin))) {
+                standardInputFiles.emplace_back(content);
+            }
+        }
+        vector<fs::path> filenames;
+        for (const auto& file: standardInputFiles) {
+            filenames.push_back(file.GetPath());
+        }
+        return filenames;
+    };
+    // path of a single input gas file
+    auto resolveInput = [&](const fs::path& filename) {
+        if (!tools::isStandardStream(filename)) {
+            return filename;
+        }
+        const auto filenames = readStandardInput();
+        if (filenames.size() != 1) {
+            cerr << "Expected one gas file from standard input, found " << filenames.size() << endl;
+            exit(1);
+        }
+        return filenames.front();
+    };
+    auto resolveOutput = [&outputDirectory](const fs::path& filename) {
+        if (tools::isStandardStream(filename) || filename.is_absolute()) {
+            return filename;
+        }
+        return outputDirectory / filename;
+    };
+
+    auto writeGas = [&](const Gas& gas, const fs::path& filename) {
+        if (!tools::isStandardStream(filename)) {
+            return gas.Write(filename);
+        }
+        const tools::TemporaryFile file;
+        return gas.Write(file.GetPath()) && tools::writeToFileDescriptor(dataOutput, tools::readFile(file.GetPath()));
+    };
+
+    // gas files given by the user are expected to exist, exit with the error otherwise
+    auto loadGas = [&resolveInput](const fs::path& filename) {
+        string error;
+        auto gas = Gas::FromFile(resolveInput(filename), &error);
+        if (!gas) {
+            cerr << error << endl;
+            exit(1);
+        }
+        return std::move(*gas);
+    };
+
+    shared_ptr<GenerationBackend> backend = make_shared<MagboltzBackend>();
+    if (backendName == "synthetic") {
+        backend = make_shared<SyntheticBackend>(syntheticLatency, syntheticNoise, syntheticSeed);
+    }
+
     const auto subcommand = app.get_subcommands().back();
     const string subcommandName = subcommand->get_name();
 
+    // simulation settings from '--thermal' and '--penning' (enqueue, repair, catalog query), 'defaults' for the ones not given
+    auto generationOptions = [&](GenerationOptions defaults) {
+        if (!thermalMotionOption.empty()) {
+            defaults.thermalMotion = thermalMotionOption == "on";
+        }
+        bool penningGiven = false;
+        for (CLI::App* optionSubcommand: {enqueue, repair, catalogQuery}) {
+            penningGiven = penningGiven || (optionSubcommand->parsed() && !optionSubcommand->get_option("--penning")->empty());
+        }
+        if (penningGiven) {
+            defaults.penningTransferRate = penningTransferRateOption;
+        }
+        return defaults;
+    };
+
     // generate electric field values from user options
     auto& eField = subcommandGasElectricFieldValues;
     {
@@ -103,87 +313,121 @@ int main(int argc, char** argv) {
         }
     }
 
+    // gas components from user options (generate, enqueue, catalog query)
+    vector<pair<string, double>> gasComponents;
+    if (!generateGasComponentsString.empty()) {
+        vector<string> components;
+        vector<double> fractions;
+
+        regex rgx("^[0-9]+([.][0-9]+)?"); // only positive (decimal) numbers
+        for (const auto& componentString: generateGasComponentsString) {
+            std::smatch matches;
+            if (std::regex_search(componentString, matches, rgx)) {
+                fractions.push_back(stod(componentString));
+            } else {
+                components.push_back(componentString);
+            }
+        }
+
+        if (!components.empty() && fractions.size() == components.size() - 1) {
+            double sum = 0;
+            for (const auto& value: fractions) { sum += value; }
+            const double inferredPercentage = 100.0 - sum;
+            fractions.emplace_back(inferredPercentage);
+            cerr << "Warning: Inferred fraction of " << inferredPercentage << "% for component " << components.back() << endl;
+        }
+
+        if (components.size() != fractions.size()) {
+            cerr << "Error parsing components: number of component names and fractions mismatch" << endl;
+            exit(1);
+        }
+
+        // do not allow negative fractions
+        for (int i = 0; i < fractions.size(); ++i) {
+            if (fractions[i] < 0) {
+                cerr << "Error: Fraction of component " << components[i] << " cannot be negative: " << fractions[i] << endl;
+                exit(1);
+            }
+        }
+
+        for (size_t i = 0; i < components.size(); ++i) {
+            // if component fraction is zero, do not add it to the gas
+            if (fractions[i] == 0) {
+                cerr << "Warning: Component " << components[i] << " has zero fraction, will not be added to gas" << endl;
+                continue;
+            }
+            gasComponents.emplace_back(components[i], fractions[i]);
+        }
+    }
+
     if (subcommandName == "read") {
         cout << "Reading gas properties from file: " << gasFilenameInput << endl;
-        Gas gas(gasFilenameInput);
+        const auto gas = loadGas(gasFilenameInput);
 
         // if user specified electric field values, those values will be used, otherwise the gas file will be read for the electric field values
-        const auto gasProperties = gas.GetGasPropertiesJson(eField);
+        nlohmann::json gasProperties;
+        try {
+            gasProperties = gas.GetGasPropertiesJson(eField);
+        } catch (const exception& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
 
-        if (read->get_option("--json")->empty()) {
+        string content;
+        if (readFormat == "json") {
+            content = gasProperties.dump();
+        } else {
+            vector<uint8_t> binary;
+            if (readFormat == "cbor") {
+                binary = nlohmann::json::to_cbor(gasProperties);
+            } else if (readFormat == "msgpack") {
+                binary = nlohmann::json::to_msgpack(gasProperties);
+            } else if (readFormat == "bson") {
+                binary = nlohmann::json::to_bson(gasProperties);
+            } else {
+                binary = nlohmann::json::to_ubjson(gasProperties);
+            }
+            content.assign(binary.begin(), binary.end());
+        }
+
+        if (readFormat == "json" && read->get_option("--json")->empty()) {
             // print electric field info
             const auto& eFieldValues = gasProperties["electric_field"];
             cout << "Number of electric field values: " << eFieldValues.size() << endl;
             cout << gasProperties.dump(4) << endl;
+        } else if (read->get_option("--json")->empty() || tools::isStandardStream(gasPropertiesJsonFilename)) {
+            tools::writeToFileDescriptor(dataOutput, content);
         } else {
             if (gasPropertiesJsonFilename.empty()) {
-                gasPropertiesJsonFilename = string(gasFilenameInput.filename()) + ".json";
+                const string inputName = tools::isStandardStream(gasFilenameInput) ? gas.GetName() + ".gas" : gasFilenameInput.filename().string();
+                gasPropertiesJsonFilename = inputName + "." + readFormat;
             }
             gasPropertiesJsonFilename = outputDirectory / gasPropertiesJsonFilename;
 
-            cout << "Gas properties json will be saved to " << gasPropertiesJsonFilename << endl;
-            tools::writeToFile(gasPropertiesJsonFilename, gasProperties.dump());
+            cout << "Gas properties " << readFormat << " will be saved to " << gasPropertiesJsonFilename << endl;
+            tools::writeToFile(gasPropertiesJsonFilename, content);
         }
     } else if (subcommandName == "generate") {
-        vector<pair<string, double>> gasComponents;
-        {
-            vector<string> components;
-            vector<double> fractions;
-
-            regex rgx("^[0-9]+([.][0-9]+)?"); // only positive (decimal) numbers
-            for (const auto& componentString: generateGasComponentsString) {
-                std::smatch matches;
-                if (std::regex_search(componentString, matches, rgx)) {
-                    fractions.push_back(stod(componentString));
-                } else {
-                    components.push_back(componentString);
-                }
-            }
-
-            if (!components.empty() && fractions.size() == components.size() - 1) {
-                double sum = 0;
-                for (const auto& value: fractions) { sum += value; }
-                const double inferredPercentage = 100.0 - sum;
-                fractions.emplace_back(inferredPercentage);
-                cerr << "Warning: Inferred fraction of " << inferredPercentage << "% for component " << components.back() << endl;
-            }
-
-            if (components.size() != fractions.size()) {
-                cerr << "Error parsing components: number of component names and fractions mismatch" << endl;
-                exit(1);
-            }
-
-            // do not allow negative fractions
-            for (int i = 0; i < fractions.size(); ++i) {
-                if (fractions[i] < 0) {
-                    cerr << "Error: Fraction of component " << components[i] << " cannot be negative: " << fractions[i] << endl;
-                    exit(1);
-                }
-            }
-
-            for (size_t i = 0; i < components.size(); ++i) {
-                // if component fraction is zero, do not add it to the gas
-                if (fractions[i] == 0) {
-                    cerr << "Warning: Component " << components[i] << " has zero fraction, will not be added to gas" << endl;
-                    continue;
-                }
-                gasComponents.emplace_back(components[i], fractions[i]);
-            }
-        }
-
         tools::removeSimilarElements(eField);
         if (eField.empty()) {
             cerr << "No electric field values provided (--help)" << endl;
             return 1;
         }
 
-        // validation is handled in constructor
-        Gas gas(gasComponents);
+        string gasError;
+        auto gasMaybe = Gas::FromComponents(gasComponents, &gasError);
+        if (!gasMaybe) {
+            cerr << gasError << endl;
+            return 1;
+        }
+        auto& gas = *gasMaybe;
+        gas.SetBackend(backend);
 
         gas.SetPressure(pressure);
         gas.SetTemperature(temperature);
 
-        if (gasFilenameOutput.empty()) {
+        string defaultGasFilename;
+        {
             string name = gas.GetName();
             name += "-T" + tools::numberToCleanNumberString(temperature) + "C";
             name += "-P" + tools::numberToCleanNumberString(pressure) + "bar";
@@ -207,58 +451,193 @@ int main(int argc, char** argv) {
                 }
             }
             name += ".gas";
-            gasFilenameOutput = name;
+            defaultGasFilename = name;
+        }
+        if (gasFilenameOutput.empty()) {
+            gasFilenameOutput = defaultGasFilename;
         }
+        gasFilenameOutput = resolveOutput(gasFilenameOutput);
+
+        // simulation settings variants, e.g. '--variants thermal=on,off --penning 0.3,0.5'
+        vector<bool> thermalMotionValues;
+        vector<double> penningRates = generatePenningRates;
+        for (const auto& variant: generateVariants) {
+            const auto separator = variant.find('=');
+            const string key = variant.substr(0, separator);
+            istringstream values(separator == string::npos ? "" : variant.substr(separator + 1));
+            string value;
+            while (getline(values, value, ',')) {
+                if (key == "thermal" && (value == "on" || value == "off")) {
+                    thermalMotionValues.push_back(value == "on");
+                } else if (key == "penning" && regex_match(value, regex("^[0-9]*[.]?[0-9]+$")) && stod(value) <= 1) {
+                    penningRates.push_back(stod(value));
+                } else {
+                    cerr << "Error parsing variant '" << variant << "': expected 'thermal=on,off' or 'penning=<rate>,...' with rates between 0 and 1" << endl;
+                    return 1;
+                }
+            }
+        }
+        const bool generateVariantsEnabled = !thermalMotionValues.empty() || !penningRates.empty();
+        const auto variants = generationVariants(thermalMotionValues, penningRates);
+
+        auto provenance = [&]() {
+            nlohmann::json result;
+            result["backend"] = backend->GetName();
+            result["number_of_collisions"] = numberOfCollisions;
+            result["options"] = backend->GetOptions();
+            return result;
+        };
+
+        // generate into 'filename', saving progress after every electric field value if requested
+        auto generateInto = [&](Gas& gas, const fs::path& filename) {
+            {
+                // create empty file
+                fs::remove(filename);
+                ofstream ofs(filename);
+                ofs.close();
+
+                if (!fs::exists(filename)) {
+                    cerr << "Gas file '" << filename << "' could not be created" << endl;
+                    return false;
+                }
+            }
+
+            if (!generateProgress) {
+                gas.Generate(eField, numberOfCollisions, generateVerbose);
+                return gas.Write(filename);
+            }
+            auto values = eField;
+            tools::sortVectorForCompute(values);
+            for (int i = 0; i < values.size(); i++) {
+                gas.Generate({values[i]}, numberOfCollisions, generateVerbose);
+                if (i > 0) {
+                    gas.Merge(filename);
+                }
+                cout << "Progress: " << i + 1 << "/" << values.size() << endl;
+                gas.Write(filename);
+            }
+            return true;
+        };
+
+        if (generateVariantsEnabled) {
+            if (tools::isStandardStream(gasFilenameOutput)) {
+                cerr << "Variants cannot be written to standard output" << endl;
+                return 1;
+            }
+            if (!generate->get_option("--json")->empty()) {
+                cerr << "A json file is saved next to every variant, '--json' cannot be used with variants" << endl;
+                return 1;
+            }
+
+            auto variantFilename = [&gasFilenameOutput](const GenerationOptions& options) {
+                return gasFilenameOutput.parent_path() / (gasFilenameOutput.stem().string() + "-" + options.GetSuffix() + gasFilenameOutput.extension().string());
+            };
+
+            // Penning transfer only changes the Townsend coefficient: simulate once per thermal motion setting without it
+            // and derive every rate from that table
+            vector<bool> simulations;
+            for (const auto& options: variants) {
+                if (find(simulations.begin(), simulations.end(), options.thermalMotion) == simulations.end()) {
+                    simulations.push_back(options.thermalMotion);
+                }
+            }
+
+            cout << "Generating " << variants.size() << " variants (" << simulations.size() << " simulations, " << min<size_t>(jobs, simulations.size()) << " processes):" << endl;
+            for (const auto& options: variants) {
+                cout << "    - " << variantFilename(options) << endl;
+            }
+
+            if (generateTestOnly) {
+                cout << "Test only, no gas file will be generated" << endl;
+                return 0;
+            }
+
+            const fs::path temporaryDirectory = fs::temp_directory_path() / ("gas-cli-variants-" + to_string(getpid()));
+            fs::create_directories(temporaryDirectory);
+            auto simulationFilename = [&temporaryDirectory](size_t k) { return temporaryDirectory / ("simulation-" + to_string(k) + ".gas"); };
+
+            // the gas is set up once here, every process only runs the simulation of its thermal motion setting
+            const auto failedSimulations = tools::forkEach(simulations.size(), jobs, [&](size_t k) {
+                backend->SetOptions({simulations[k], 0});
+                return generateInto(gas, simulationFilename(k)) ? 0 : 1;
+            });
+
+            vector<size_t> failed;
+            for (size_t i = 0; i < variants.size(); i++) {
+                const auto& options = variants[i];
+                const size_t k = find(simulations.begin(), simulations.end(), options.thermalMotion) - simulations.begin();
+                const auto filename = variantFilename(options);
+
+                optional<Gas> variant;
+                if (find(failedSimulations.begin(), failedSimulations.end(), k) == failedSimulations.end()) {
+                    variant = Gas::FromFile(simulationFilename(k));
+                }
+                if (variant) {
+                    variant->SetBackend(backend);
+                    backend->SetOptions(options);
+                }
+                if (!variant || !variant->ApplyPenningTransfer(options.penningTransferRate) || !variant->Write(filename)) {
+                    failed.push_back(i);
+                    continue;
+                }
+                auto properties = variant->GetGasPropertiesJson();
+                properties["provenance"] = provenance();
+                properties["provenance"]["gas_file"] = filename.filename().string();
+                tools::writeToFile(filename.string() + ".json", properties.dump());
+            }
+            fs::remove_all(temporaryDirectory);
 
-        if (!gasFilenameOutput.is_absolute()) {
-            gasFilenameOutput = outputDirectory / gasFilenameOutput;
+            for (const size_t i: failed) {
+                cerr << "Error: generation of variant " << variantFilename(variants[i]) << " failed" << endl;
+            }
+            cout << "Generated " << variants.size() - failed.size() << "/" << variants.size() << " variants" << endl;
+            return failed.empty() ? 0 : 1;
         }
 
-        cout << "Gas file will be saved to " << gasFilenameOutput << endl;
+        cout << "Gas file will be saved to " << (tools::isStandardStream(gasFilenameOutput) ? "standard output" : gasFilenameOutput.string()) << endl;
 
         if (generateTestOnly) {
             cout << "Test only, no gas file will be generated" << endl;
             return 0;
         }
 
-        {
-            // create empty file
-            fs::remove(gasFilenameOutput);
-            ofstream ofs(gasFilenameOutput);
-            ofs.close();
+        // progress is saved into a local temporary file when the output is standard output
+        optional<tools::TemporaryFile> progressFile;
+        if (tools::isStandardStream(gasFilenameOutput)) {
+            progressFile.emplace();
+        }
+        const fs::path progressFilename = progressFile ? progressFile->GetPath() : gasFilenameOutput;
 
-            if (!fs::exists(gasFilenameOutput)) {
-                cerr << "Gas file '" << gasFilenameOutput << "' could not be created" << endl;
-                return 1;
-            }
+        if (!generateInto(gas, progressFilename)) {
+            return 1;
         }
 
-        if (!generateProgress) {
-            gas.Generate(eField, numberOfCollisions, generateVerbose);
-            gas.Write(gasFilenameOutput);
-        } else {
-            tools::sortVectorForCompute(eField);
-            for (int i = 0; i < eField.size(); i++) {
-                gas.Generate({eField[i]}, numberOfCollisions, generateVerbose);
-                if (i > 0) {
-                    gas.Merge(gasFilenameOutput);
-                }
-                cout << "Progress: " << i + 1 << "/" << eField.size() << endl;
-                gas.Write(gasFilenameOutput);
+        if (progressFile) {
+            if (!tools::writeToFileDescriptor(dataOutput, tools::readFile(progressFilename))) {
+                cerr << "Error writing gas file to standard output" << endl;
+                return 1;
             }
+            cout << "Gas file written to standard output" << endl;
+        } else {
+            cout << "Gas file saved to " << gasFilenameOutput << endl;
         }
 
-        cout << "Gas file saved to " << gasFilenameOutput << endl;
-
         if (!generate->get_option("--json")->empty()) {
             // user specified to also save gas properties as json
             if (gasPropertiesJsonFilename.empty()) {
-                gasPropertiesJsonFilename = string(gasFilenameOutput.filename()) + ".json";
+                gasPropertiesJsonFilename = (progressFile ? defaultGasFilename : gasFilenameOutput.filename().string()) + ".json";
             }
-            gasPropertiesJsonFilename = outputDirectory / gasPropertiesJsonFilename;
+            gasPropertiesJsonFilename = resolveOutput(gasPropertiesJsonFilename);
 
-            cout << "Gas properties json will be saved to " << gasPropertiesJsonFilename << endl;
-            tools::writeToFile(gasPropertiesJsonFilename, gas.GetGasPropertiesJson().dump());
+            auto properties = gas.GetGasPropertiesJson();
+            properties["provenance"] = provenance();
+            const string content = properties.dump();
+            if (tools::isStandardStream(gasPropertiesJsonFilename)) {
+                tools::writeToFileDescriptor(dataOutput, content);
+            } else {
+                cout << "Gas properties json will be saved to " << gasPropertiesJsonFilename << endl;
+                tools::writeToFile(gasPropertiesJsonFilename, content);
+            }
         }
 
         if (generatePrint) {
@@ -266,11 +645,34 @@ int main(int argc, char** argv) {
         }
 
     } else if (subcommandName == "merge") {
-        if (!gasFilenameOutput.is_absolute()) {
-            gasFilenameOutput = outputDirectory / gasFilenameOutput;
+        gasFilenameOutput = resolveOutput(gasFilenameOutput);
+        if (tools::isStandardStream(gasFilenameOutput) && mergeCompressOutput) {
+            cerr << "Gas file written to standard output cannot be compressed" << endl;
+            return 1;
         }
 
-        cout << "Gas file will be saved to " << gasFilenameOutput << endl;
+        cout << "Gas file will be saved to " << (tools::isStandardStream(gasFilenameOutput) ? "standard output" : gasFilenameOutput.string()) << endl;
+
+        // standard input can contain several concatenated gas files, they replace the '-' entry
+        {
+            const auto standardInput = find_if(mergeGasInputFilenames.begin(), mergeGasInputFilenames.end(), tools::isStandardStream);
+            if (standardInput != mergeGasInputFilenames.end()) {
+                if (count_if(mergeGasInputFilenames.begin(), mergeGasInputFilenames.end(), tools::isStandardStream) > 1) {
+                    cerr << "Standard input ('-') can only be given once" << endl;
+                    return 1;
+                }
+                const auto filenames = readStandardInput();
+                cout << "Read " << filenames.size() << " gas files from standard input" << endl;
+                const auto position = mergeGasInputFilenames.erase(standardInput);
+                mergeGasInputFilenames.insert(position, filenames.begin(), filenames.end());
+            }
+        }
+
+        if (!queueDirectory.empty()) {
+            const auto queueResults = workqueue::results(queueDirectory);
+            cout << "Adding " << queueResults.size() << " results from queue " << queueDirectory << endl;
+            mergeGasInputFilenames.insert(mergeGasInputFilenames.end(), queueResults.begin(), queueResults.end());
+        }
 
         // check if any file is empty and remove them
         {
@@ -297,14 +699,14 @@ int main(int argc, char** argv) {
             cout << "    - " << filename << endl;
         }
 
-        auto gas = Gas(mergeGasInputFilenames[0]);
+        auto gas = loadGas(mergeGasInputFilenames[0]);
         for (unsigned int i = 1; i < mergeGasInputFilenames.size(); i++) {
             const auto& toMerge = mergeGasInputFilenames[i];
             cout << "Merging " << toMerge << endl;
 
             if (mergeVerbose) {
                 {
-                    const auto values = Gas(toMerge).GetTableElectricField();
+                    const auto values = loadGas(toMerge).GetTableElectricField();
                     cout << "Electric field values (V/cm) for file to merge (" << values.size() << "):";
                     for (const auto& value: values) {
                         cout << " " << value;
@@ -329,7 +731,10 @@ int main(int argc, char** argv) {
             }
         }
 
-        gas.Write(gasFilenameOutput);
+        if (!writeGas(gas, gasFilenameOutput)) {
+            cerr << "Error writing gas file '" << gasFilenameOutput << "'" << endl;
+            return 1;
+        }
 
         if (mergeVerbose) {
             const auto values = gas.GetTableElectricField();
@@ -352,5 +757,435 @@ int main(int argc, char** argv) {
             // return to original path
             fs::current_path(currentPath);
         }
+    } else if (subcommandName == "compact") {
+        cout << "Compacting gas file " << gasFilenameInput << " with relative tolerance " << compactRelativeTolerance << endl;
+        auto gas = loadGas(gasFilenameInput);
+
+        if (gasFilenameOutput.empty()) {
+            const string stem = tools::isStandardStream(gasFilenameInput) ? gas.GetName() : gasFilenameInput.stem().string();
+            gasFilenameOutput = stem + "-compact.gas";
+        }
+        gasFilenameOutput = resolveOutput(gasFilenameOutput);
+
+        const auto& table = gas.GetTable();
+        const auto properties = table.GetProperties();
+
+        vector<vector<double>> values;
+        for (const auto& [name, property]: properties) {
+            values.push_back(*property);
+        }
+        auto kept = tools::compactIndices(table.electricField, values, compactRelativeTolerance);
+
+        // users read the gas file through the interpolation of Garfield (not linear): keep the worst dropped value
+        // between two kept values until every dropped value is reproduced within tolerance
+        const auto original = gas.GetInterpolatedTable(table.electricField);
+        const auto originalProperties = original.GetProperties();
+        optional<Gas> compacted;
+        vector<double> maxErrors;
+        while (true) {
+            compacted = gas.SelectElectricFieldValues(kept);
+            if (!compacted) {
+                cerr << "Error removing electric field values from gas file" << endl;
+                return 1;
+            }
+            const auto interpolated = compacted->GetInterpolatedTable(table.electricField);
+            const auto interpolatedProperties = interpolated.GetProperties();
+
+            vector<double> errors(table.electricField.size(), 0);
+            maxErrors.assign(properties.size(), 0);
+            for (size_t p = 0; p < properties.size(); p++) {
+                for (size_t i = 0; i < table.electricField.size(); i++) {
+                    const double error = tools::relativeError(originalProperties[p].second->at(i), interpolatedProperties[p].second->at(i));
+                    errors[i] = max(errors[i], error);
+                    maxErrors[p] = max(maxErrors[p], error);
+                }
+            }
+
+            vector<size_t> added;
+            for (size_t k = 0; k + 1 < kept.size(); k++) {
+                const auto worst = max_element(errors.begin() + kept[k] + 1, errors.begin() + kept[k + 1]);
+                if (worst != errors.begin() + kept[k + 1] && *worst > compactRelativeTolerance) {
+                    added.push_back(worst - errors.begin());
+                }
+            }
+            if (added.empty()) {
+                break;
+            }
+            kept.insert(kept.end(), added.begin(), added.end());
+            sort(kept.begin(), kept.end());
+        }
+
+        cout << "Number of electric field values: " << table.electricField.size() << " -> " << kept.size() << endl;
+        cout << "Maximum relative error (Garfield interpolation of the compacted gas file):" << endl;
+        for (size_t p = 0; p < properties.size(); p++) {
+            cout << "    - " << properties[p].first << ": " << maxErrors[p] << endl;
+        }
+
+        if (!writeGas(*compacted, gasFilenameOutput)) {
+            cerr << "Error writing gas file '" << gasFilenameOutput << "'" << endl;
+            return 1;
+        }
+
+        cout << "Gas file saved to " << gasFilenameOutput << endl;
+    } else if (subcommandName == "enqueue") {
+        tools::removeSimilarElements(eField);
+        if (eField.empty()) {
+            cerr << "No electric field values provided (--help)" << endl;
+            return 1;
+        }
+
+        // validate the gas before any task is added
+        string gasError;
+        if (!Gas::FromComponents(gasComponents, &gasError)) {
+            cerr << gasError << endl;
+            return 1;
+        }
+
+        // tasks are claimed in order, this way partial results already cover the whole range
+        tools::sortVectorForCompute(eField);
+
+        vector<nlohmann::json> tasks;
+        for (const double e: eField) {
+            nlohmann::json task;
+            task["components"] = gasComponents;
+            task["temperature"] = temperature;
+            task["pressure"] = pressure;
+            task["collisions"] = numberOfCollisions;
+            task["electric_field"] = e;
+            task["options"] = generationOptions({});
+            tasks.push_back(task);
+        }
+
+        const auto ids = workqueue::enqueue(queueDirectory, tasks);
+        cout << "Added " << ids.size() << " tasks to queue " << queueDirectory << endl;
+        if (ids.size() != tasks.size()) {
+            return 1;
+        }
+    } else if (subcommandName == "worker") {
+        const auto lease = chrono::seconds(workerLeaseSeconds);
+
+        string workerName;
+        {
+            char hostname[256] = {};
+            gethostname(hostname, sizeof(hostname) - 1);
+            workerName = string(hostname) + "-" + to_string(getpid());
+        }
+        cout << "Worker " << workerName << " processing queue " << queueDirectory << endl;
+
+        unsigned int processed = 0;
+        while (true) {
+            workqueue::requeueExpired(queueDirectory, lease);
+
+            const auto task = workqueue::claim(queueDirectory, workerName);
+            if (!task) {
+                if (workqueue::countClaimed(queueDirectory) == 0) {
+                    break;
+                }
+                // other workers are busy, wait in case some of them died and their tasks need to be processed again
+                this_thread::sleep_for(chrono::seconds(workerPollSeconds));
+                continue;
+            }
+
+            const double e = task->parameters["electric_field"];
+            cout << "Processing task " << task->id << " (" << e << " V/cm)" << endl;
+
+            // keep the lease alive while Magboltz runs
+            mutex heartbeatMutex;
+            condition_variable heartbeatCondition;
+            bool finished = false;
+            bool leaseLost = false;
+            thread heartbeat([&]() {
+                unique_lock<mutex> lock(heartbeatMutex);
+                while (!heartbeatCondition.wait_for(lock, chrono::milliseconds(lease) / 4, [&finished]() { return finished; })) {
+                    if (!leaseLost && !workqueue::heartbeat(queueDirectory, *task)) {
+                        leaseLost = true;
+                        cerr << "Warning: lease of task " << task->id << " lost, it will be processed again by another worker" << endl;
+                    }
+                }
+            });
+
+            bool ok = false;
+            try {
+                // tasks of queues created before options were stored used the defaults
+                backend->SetOptions(task->parameters.value("options", nlohmann::json(GenerationOptions())).get<GenerationOptions>());
+
+                Gas gas(task->parameters["components"].get<vector<pair<string, double>>>());
+                gas.SetBackend(backend);
+                gas.SetPressure(task->parameters["pressure"]);
+                gas.SetTemperature(task->parameters["temperature"]);
+                gas.Generate({e}, task->parameters["collisions"], workerVerbose);
+
+                // write to a hidden file first so partial results are never merged
+                const fs::path result = workqueue::resultPath(queueDirectory, *task);
+                const fs::path temporary = result.parent_path() / ("." + result.filename().string() + "." + workerName);
+                if (gas.Write(temporary)) {
+                    error_code ec;
+                    fs::rename(temporary, result, ec);
+                    ok = !ec;
+                }
+            } catch (const exception& error) {
+                cerr << "Error processing task " << task->id << ": " << error.what() << endl;
+            }
+
+            {
+                lock_guard<mutex> lock(heartbeatMutex);
+                finished = true;
+            }
+            heartbeatCondition.notify_one();
+            heartbeat.join();
+
+            if (!ok) {
+                if (leaseLost || !workqueue::fail(queueDirectory, *task, workerMaxAttempts)) {
+                    cerr << "Error: task " << task->id << " failed, it is no longer claimed by this worker" << endl;
+                } else if (task->attempts + 1 < workerMaxAttempts) {
+                    cerr << "Error: task " << task->id << " failed (attempt " << task->attempts + 1 << "/" << workerMaxAttempts << "), returning it to the queue" << endl;
+                } else {
+                    cerr << "Error: task " << task->id << " failed " << workerMaxAttempts << " times, moved to the failed tasks" << endl;
+                }
+                continue;
+            }
+
+            if (leaseLost || !workqueue::complete(queueDirectory, *task)) {
+                // the task went back to pending (lease expired), whoever claims it next completes it
+                cerr << "Warning: task " << task->id << " is no longer claimed by this worker, it is not counted as processed" << endl;
+                continue;
+            }
+            processed++;
+            cout << "Task " << task->id << " done. Pending: " << workqueue::countPending(queueDirectory) << ", in progress: " << workqueue::countClaimed(queueDirectory) << ", done: " << workqueue::countDone(queueDirectory) << ", failed: " << workqueue::countFailed(queueDirectory) << endl;
+        }
+
+        cout << "No tasks left in queue, worker processed " << processed << " tasks" << endl;
+        if (const size_t failed = workqueue::countFailed(queueDirectory)) {
+            cerr << "Error: " << failed << " tasks of the queue failed " << workerMaxAttempts << " times (see " << queueDirectory / "failed" << ")" << endl;
+            return 1;
+        }
+    } else if (subcommandName == "catalog") {
+        if (catalogBuild->parsed()) {
+            const fs::path indexFilename = catalogDirectory / catalog::indexFilename;
+
+            // entries of files that did not change since the last build are reused
+            vector<catalog::Entry> previous;
+            if (fs::exists(indexFilename)) {
+                if (const auto entries = catalog::read(indexFilename)) {
+                    previous = *entries;
+                }
+            }
+
+            const auto entries = catalog::build(catalogDirectory, previous, catalogVerbose);
+            if (!catalog::write(indexFilename, entries)) {
+                cerr << "Error writing catalog index " << indexFilename << endl;
+                return 1;
+            }
+            cout << "Indexed " << entries.size() << " gas files into " << indexFilename << endl;
+        } else if (catalogQuery->parsed()) {
+            fs::path indexFilename = catalogDirectory;
+            if (fs::is_directory(indexFilename)) {
+                indexFilename /= catalog::indexFilename;
+            }
+            catalogDirectory = indexFilename.parent_path();
+
+            const auto entries = catalog::read(indexFilename);
+            if (!entries) {
+                cerr << "Error reading catalog index " << indexFilename << " (use 'catalog build' to create it)" << endl;
+                return 1;
+            }
+
+            const catalog::Query query{gasComponents, temperature, pressure, generationOptions({})};
+            const auto matches = catalog::nearest(*entries, query, catalogQueryCount);
+            if (matches.empty()) {
+                cerr << "No table found with the same components and options ('" << query.options.GetSuffix() << "')" << endl;
+                return 1;
+            }
+
+            constexpr double exactDistance = 1E-6;
+            cout << "Closest tables (distance: 1% fraction = 10 C = 10% pressure = 1):" << endl;
+            for (const auto& [distance, entry]: matches) {
+                cout << "    - " << (distance < exactDistance ? "exact" : to_string(distance)) << ": " << entry->file
+                     << " (T=" << entry->temperature << "C, P=" << entry->pressure << "bar, E=" << entry->electricFieldMin << "-" << entry->electricFieldMax
+                     << "V/cm, nE=" << entry->numberOfElectricFieldValues << ", nColl=" << entry->numberOfCollisions << ", " << entry->options.GetSuffix() << ")" << endl;
+            }
+
+            const bool exact = matches.front().first < exactDistance;
+            nlohmann::json gasProperties;
+            if (exact) {
+                const auto gas = loadGas(catalogDirectory / matches.front().second->file);
+                try {
+                    gasProperties = gas.GetGasPropertiesJson(eField);
+                } catch (const exception& e) {
+                    cerr << e.what() << endl;
+                    return 1;
+                }
+                gasProperties["catalog"]["files"] = {matches.front().second->file};
+                gasProperties["catalog"]["weights"] = {1.0};
+            } else if (catalogInterpolate) {
+                const auto bracket = catalog::bracket(*entries, query, catalogInterpolationTolerance);
+                if (!bracket) {
+                    cerr << "Error: no pair of tables with the query between them (within tolerance " << catalogInterpolationTolerance << "), cannot interpolate" << endl;
+                    return 1;
+                }
+                const auto [a, b, weight, offLineDistance] = *bracket;
+                cout << "Interpolating between " << a->file << " and " << b->file << " (weight " << weight << ", distance of the query to the segment " << offLineDistance << ")" << endl;
+
+                // transport properties depend on E/p: Garfield rescales both tables to the pressure (and temperature) of the
+                // query, the weight only covers what is left (mixture, temperature)
+                auto gasA = loadGas(catalogDirectory / a->file);
+                auto gasB = loadGas(catalogDirectory / b->file);
+                for (Gas* gas: {&gasA, &gasB}) {
+                    gas->SetPressure(pressure);
+                    gas->SetTemperature(temperature);
+                }
+
+                // only electric field values covered by both tables, at the pressure of the query
+                const double min = std::max(a->electricFieldMin * pressure / a->pressure, b->electricFieldMin * pressure / b->pressure);
+                const double max = std::min(a->electricFieldMax * pressure / a->pressure, b->electricFieldMax * pressure / b->pressure);
+                vector<double> tableElectricField;
+                for (const double e: gasA.GetTableElectricField()) {
+                    tableElectricField.push_back(e * pressure / a->pressure);
+                }
+                vector<double> electricField;
+                for (const double e: eField.empty() ? tableElectricField : eField) {
+                    if (e >= min && e <= max) {
+                        electricField.push_back(e);
+                    } else if (!eField.empty()) {
+                        cerr << "Warning: electric field value '" << e << "' is outside the range covered by both tables (" << min << ", " << max << ")" << endl;
+                    }
+                }
+                if (electricField.empty()) {
+                    cerr << "Error: no electric field values in the range covered by both tables (" << min << ", " << max << ")" << endl;
+                    return 1;
+                }
+
+                gasProperties = catalog::interpolate(gasA, gasB, weight, electricField);
+                const Gas queryGas(gasComponents);
+                gasProperties["name"] = queryGas.GetName();
+                gasProperties["temperature"] = temperature;
+                gasProperties["pressure"] = pressure;
+                const auto components = queryGas.GetComponents();
+                gasProperties["components"]["labels"] = components.first;
+                gasProperties["components"]["fractions"] = components.second;
+                gasProperties["catalog"]["files"] = {a->file, b->file};
+                gasProperties["catalog"]["weights"] = {1 - weight, weight};
+                gasProperties["catalog"]["off_line_distance"] = offLineDistance;
+            } else {
+                return 0;
+            }
+
+            if (catalogQuery->get_option("--json")->empty()) {
+                cout << gasProperties.dump(4) << endl;
+            } else if (tools::isStandardStream(gasPropertiesJsonFilename)) {
+                tools::writeToFileDescriptor(dataOutput, gasProperties.dump());
+            } else {
+                cout << "Gas properties json will be saved to " << gasPropertiesJsonFilename << endl;
+                tools::writeToFile(gasPropertiesJsonFilename, gasProperties.dump());
+            }
+        }
+    } else if (subcommandName == "repair") {
+        // forked workers read the input again, standard input is only available once
+        const fs::path inputFilename = resolveInput(gasFilenameInput);
+        auto gas = loadGas(inputFilename);
+        const auto table = gas.GetTable();
+
+        if (gasFilenameOutput.empty()) {
+            const string stem = tools::isStandardStream(gasFilenameInput) ? gas.GetName() : gasFilenameInput.stem().string();
+            gasFilenameOutput = stem + "-repaired.gas";
+        }
+        gasFilenameOutput = resolveOutput(gasFilenameOutput);
+
+        // generated values replace the old ones, they must be simulated with the settings of the input table
+        const auto variantOptions = GenerationOptions::FromFilename(gasFilenameInput.filename().string());
+        const auto options = generationOptions(variantOptions.value_or(GenerationOptions()));
+        if (variantOptions && options != *variantOptions) {
+            cerr << "Error: input file name is a '" << variantOptions->GetSuffix() << "' variant, values cannot be generated again with '" << options.GetSuffix() << "'" << endl;
+            return 1;
+        }
+        backend->SetOptions(options);
+
+        vector<size_t> flagged;
+        cout << "Outliers (window " << repairWindow << ", threshold " << repairThreshold << "):" << endl;
+        for (const auto& [name, values]: table.GetProperties()) {
+            if (all_of(values->begin(), values->end(), [](double value) { return value == 0; })) {
+                continue;
+            }
+            const auto outliers = tools::findOutliers(table.electricField, *values, repairWindow, repairThreshold);
+            cout << "    - " << name << " (" << outliers.size() << "):";
+            for (const size_t i: outliers) {
+                cout << " " << table.electricField[i];
+            }
+            cout << endl;
+            flagged.insert(flagged.end(), outliers.begin(), outliers.end());
+        }
+        sort(flagged.begin(), flagged.end());
+        flagged.erase(unique(flagged.begin(), flagged.end()), flagged.end());
+
+        if (flagged.empty()) {
+            cout << "No outliers found" << endl;
+            return 0;
+        }
+        if (repairReportOnly) {
+            return 0;
+        }
+
+        if (repairCollisions == 0) {
+            const unsigned int inputCollisions = catalog::numberOfCollisionsFromFilename(gasFilenameInput.filename().string());
+            repairCollisions = inputCollisions > 0 ? 10 * inputCollisions : 100;
+        }
+        cout << "Generating " << flagged.size() << " electric field values again with " << repairCollisions << " collisions and settings '" << options.GetSuffix() << "' (" << jobs << " processes)" << endl;
+
+        const fs::path temporaryDirectory = fs::temp_directory_path() / ("gas-cli-repair-" + to_string(getpid()));
+        fs::create_directories(temporaryDirectory);
+        auto pointFilename = [&temporaryDirectory](size_t k) { return temporaryDirectory / ("point-" + to_string(k) + ".gas"); };
+
+        const auto failed = tools::forkEach(flagged.size(), jobs, [&](size_t k) {
+            // generate on a copy of the input so mixture, temperature and pressure match exactly when merging
+            auto point = Gas::FromFile(inputFilename);
+            if (!point) {
+                return 1;
+            }
+            point->SetBackend(backend);
+            point->Generate({table.electricField[flagged[k]]}, repairCollisions, repairVerbose);
+            return point->Write(pointFilename(k)) ? 0 : 1;
+        });
+
+        unsigned int repaired = 0;
+        for (size_t k = 0; k < flagged.size(); k++) {
+            const double e = table.electricField[flagged[k]];
+            if (find(failed.begin(), failed.end(), k) != failed.end()) {
+                cerr << "Warning: generation failed for electric field value " << e << " V/cm, old value will be kept" << endl;
+                continue;
+            }
+            if (!gas.Merge(pointFilename(k), true)) {
+                cerr << "Warning: could not merge electric field value " << e << " V/cm, old value will be kept" << endl;
+                continue;
+            }
+            repaired++;
+        }
+        fs::remove_all(temporaryDirectory);
+
+        cout << "Repaired " << repaired << "/" << flagged.size() << " electric field values" << endl;
+
+        if (!writeGas(gas, gasFilenameOutput)) {
+            cerr << "Error writing gas file '" << gasFilenameOutput << "'" << endl;
+            return 1;
+        }
+        cout << "Gas file saved to " << gasFilenameOutput << endl;
+    } else if (subcommandName == "export") {
+        const auto gas = loadGas(gasFilenameInput);
+        if (gas.GetTable().electricField.empty()) {
+            cerr << "Error: gas table of '" << gasFilenameInput << "' is empty" << endl;
+            return 1;
+        }
+
+        if (exportNamespace.empty()) {
+            exportNamespace = exporter::identifier(gas.GetName());
+        }
+        exportCppHeaderFilename = resolveOutput(exportCppHeaderFilename);
+
+        const auto header = exporter::cppHeader(gas, exportNamespace, gasFilenameInput.filename().string());
+        if (tools::isStandardStream(exportCppHeaderFilename)) {
+            tools::writeToFileDescriptor(dataOutput, header);
+        } else {
+            cout << "C++ header (namespace '" << exportNamespace << "') will be saved to " << exportCppHeaderFilename << endl;
+            tools::writeToFile(exportCppHeaderFilename, header);
+        }
     }
 }
@@ -0,0 +1,144 @@
+#include "Backend.h"
+
+#include "Gas.h"
+#include "Tools.h"
+
+#include "Garfield/FundamentalConstants.hh"
+
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <optional>
+#include <random>
+#include <regex>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+using namespace Garfield;
+
+string GenerationOptions::GetSuffix() const {
+    return string("thermal") + (thermalMotion ? "On" : "Off") + "-penning" + tools::numberToCleanNumberString(penningTransferRate);
+}
+
+optional<GenerationOptions> GenerationOptions::FromFilename(const string& filename) {
+    smatch matches;
+    if (!regex_search(filename, matches, regex("-thermal(On|Off)-penning([0-9]*[.]?[0-9]+)"))) {
+        return nullopt;
+    }
+    return GenerationOptions{matches[1] == "On", stod(matches[2])};
+}
+
+bool GenerationOptions::operator==(const GenerationOptions& other) const {
+    // rates are rounded in file names
+    return thermalMotion == other.thermalMotion && abs(penningTransferRate - other.penningTransferRate) < 5E-4;
+}
+
+void to_json(nlohmann::json& j, const GenerationOptions& options) {
+    j = nlohmann::json{
+            {"thermal_motion", options.thermalMotion},
+            {"penning_transfer_rate", options.penningTransferRate},
+    };
+}
+
+void from_json(const nlohmann::json& j, GenerationOptions& options) {
+    j.at("thermal_motion").get_to(options.thermalMotion);
+    j.at("penning_transfer_rate").get_to(options.penningTransferRate);
+}
+
+vector<GenerationOptions> generationVariants(const vector<bool>& thermalMotion, const vector<double>& penningTransferRates) {
+    const GenerationOptions defaults;
+    const vector<bool> thermalValues = thermalMotion.empty() ? vector<bool>{defaults.thermalMotion} : thermalMotion;
+    const vector<double> penningValues = penningTransferRates.empty() ? vector<double>{defaults.penningTransferRate} : penningTransferRates;
+
+    vector<GenerationOptions> variants;
+    for (const bool thermal: thermalValues) {
+        for (const double rate: penningValues) {
+            variants.push_back({thermal, rate});
+        }
+    }
+    return variants;
+}
+
+MediumMagboltz& GenerationBackend::GetMedium(Gas& gas) { return gas.GetMedium(); }
+
+void MagboltzBackend::Generate(Gas& gas, const vector<double>& electricFieldValues, unsigned int numberOfCollisions, bool verbose) {
+    auto& medium = GetMedium(gas);
+
+    medium.SetFieldGrid(electricFieldValues, {0.0}, {HalfPi});
+
+    if (options.thermalMotion) {
+        medium.EnableThermalMotion();
+    } else {
+        medium.DisableThermalMotion();
+    }
+    if (options.penningTransferRate > 0) {
+        // default mean distance of the transfer (lambda = 0)
+        if (!medium.EnablePenningTransfer(options.penningTransferRate, 0.)) {
+            throw runtime_error("Penning transfer rate " + to_string(options.penningTransferRate) + " could not be enabled");
+        }
+    } else {
+        medium.DisablePenningTransfer();
+    }
+
+    medium.GenerateGasTable(int(numberOfCollisions), verbose);
+}
+
+bool MagboltzBackend::ApplyPenningTransfer(Gas& gas, double rate) {
+    auto& medium = GetMedium(gas);
+    if (rate > 0) {
+        return medium.EnablePenningTransfer(rate, 0.);
+    }
+    medium.DisablePenningTransfer();
+    return true;
+}
+
+SyntheticBackend::SyntheticBackend(double latency, double noise, unsigned int seed) : latency(latency), noise(noise), seed(seed) {
+    if (latency < 0 || noise < 0) {
+        throw runtime_error("Synthetic backend latency and noise cannot be negative");
+    }
+}
+
+void SyntheticBackend::Generate(Gas& gas, const vector<double>& electricFieldValues, unsigned int, bool) {
+    const double pressure = gas.GetPressure();
+    const double temperatureRatio = (gas.GetTemperature() + ZeroCelsius) / (20.0 + ZeroCelsius);
+    // slightly different curves for different mixtures
+    const double mixtureFactor = 1.0 + 0.1 * (gas.GetComponents().first.size() - 1);
+    const double diffusionFactor = sqrt(temperatureRatio) * (options.thermalMotion ? 1.0 : 0.9);
+    const double townsendFactor = 1.0 + options.penningTransferRate;
+
+    GasTable table;
+    table.electricField = electricFieldValues;
+    for (const double e: electricFieldValues) {
+        if (latency > 0) {
+            this_thread::sleep_for(chrono::duration<double>(latency));
+        }
+
+        mt19937_64 generator(seed ^ hash<double>{}(e));
+        // the standard deviation of a normal distribution has to be positive
+        optional<normal_distribution<double>> distribution;
+        if (noise > 0) {
+            distribution.emplace(1.0, noise);
+        }
+        auto noisy = [&](double value) { return distribution ? value * (*distribution)(generator) : value; };
+
+        const double reducedField = e / pressure; // V/cm/bar
+        table.electronDriftVelocity.push_back(noisy(5.0 * mixtureFactor * reducedField / (reducedField + 200.0)));
+        table.electronTransversalDiffusion.push_back(noisy(diffusionFactor * (0.02 + 0.03 * exp(-reducedField / 300.0)) / sqrt(pressure)));
+        table.electronLongitudinalDiffusion.push_back(noisy(diffusionFactor * (0.015 + 0.02 * exp(-reducedField / 500.0)) / sqrt(pressure)));
+        // Townsend: alpha = A p exp(-B p / E)
+        table.electronTownsend.push_back(e > 0 ? noisy(townsendFactor * 9000.0 * pressure * exp(-135000.0 * pressure / e)) : 0);
+        table.electronAttachment.push_back(0);
+    }
+
+    gas.SetTable(table);
+}
+
+bool SyntheticBackend::ApplyPenningTransfer(Gas& gas, double rate) {
+    // same values as generating with the rate: the noise does not depend on it
+    auto table = gas.GetTable();
+    for (auto& value: table.electronTownsend) {
+        value *= 1.0 + rate;
+    }
+    return gas.SetTable(table);
+}
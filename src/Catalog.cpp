@@ -0,0 +1,298 @@
+#include "Catalog.h"
+
+#include "Gas.h"
+#include "Tools.h"
+
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+
+using namespace std;
+
+namespace fs = std::filesystem;
+
+namespace catalog {
+    namespace {
+        /// Components sorted by name with fractions normalized to one
+        pair<vector<string>, vector<double>> normalizeComponents(vector<pair<string, double>> components) {
+            sort(components.begin(), components.end());
+            double sum = 0;
+            for (const auto& [name, fraction]: components) { sum += fraction; }
+
+            pair<vector<string>, vector<double>> result;
+            for (const auto& [name, fraction]: components) {
+                result.first.push_back(name);
+                result.second.push_back(sum > 0 ? fraction / sum : 0);
+            }
+            return result;
+        }
+
+        /// Position in the space where 'distance' is measured
+        vector<double> coordinates(const vector<double>& fractions, double temperature, double pressure) {
+            vector<double> result;
+            for (const double fraction: fractions) {
+                result.push_back(fraction / 0.01);
+            }
+            result.push_back(temperature / 10.0);
+            result.push_back(log(pressure) / 0.1);
+            return result;
+        }
+
+        vector<double> coordinates(const Entry& entry) {
+            return coordinates(entry.fractions, entry.temperature, entry.pressure);
+        }
+
+        vector<double> coordinates(const Query& query) {
+            return coordinates(normalizeComponents(query.components).second, query.temperature, query.pressure);
+        }
+
+        double dot(const vector<double>& a, const vector<double>& b) {
+            double result = 0;
+            for (size_t i = 0; i < a.size(); i++) { result += a[i] * b[i]; }
+            return result;
+        }
+
+        vector<double> subtract(const vector<double>& a, const vector<double>& b) {
+            vector<double> result(a.size());
+            for (size_t i = 0; i < a.size(); i++) { result[i] = a[i] - b[i]; }
+            return result;
+        }
+
+        bool sameComponents(const Entry& entry, const Query& query) {
+            return entry.components == normalizeComponents(query.components).first;
+        }
+
+        const vector<pair<string, function<double(const Gas&, double)>>> properties = {
+                {"electron_drift_velocity", [](const Gas& gas, double e) { return gas.GetElectronDriftVelocity(e); }},
+                {"electron_transversal_diffusion", [](const Gas& gas, double e) { return gas.GetElectronTransversalDiffusion(e); }},
+                {"electron_longitudinal_diffusion", [](const Gas& gas, double e) { return gas.GetElectronLongitudinalDiffusion(e); }},
+                {"electron_townsend", [](const Gas& gas, double e) { return gas.GetElectronTownsend(e); }},
+                {"electron_attachment", [](const Gas& gas, double e) { return gas.GetElectronAttachment(e); }},
+        };
+    } // namespace
+
+    void to_json(nlohmann::json& j, const Entry& entry) {
+        j = nlohmann::json{
+                {"file", entry.file},
+                {"components", entry.components},
+                {"fractions", entry.fractions},
+                {"temperature", entry.temperature},
+                {"pressure", entry.pressure},
+                {"electric_field_min", entry.electricFieldMin},
+                {"electric_field_max", entry.electricFieldMax},
+                {"electric_field_values", entry.numberOfElectricFieldValues},
+                {"collisions", entry.numberOfCollisions},
+                {"options", entry.options},
+                {"file_size", entry.fileSize},
+                {"file_modified", entry.fileModified},
+        };
+    }
+
+    void from_json(const nlohmann::json& j, Entry& entry) {
+        j.at("file").get_to(entry.file);
+        j.at("components").get_to(entry.components);
+        j.at("fractions").get_to(entry.fractions);
+        j.at("temperature").get_to(entry.temperature);
+        j.at("pressure").get_to(entry.pressure);
+        j.at("electric_field_min").get_to(entry.electricFieldMin);
+        j.at("electric_field_max").get_to(entry.electricFieldMax);
+        j.at("electric_field_values").get_to(entry.numberOfElectricFieldValues);
+        j.at("collisions").get_to(entry.numberOfCollisions);
+        // indexes written before options were recorded only know the file name
+        if (j.contains("options")) {
+            j.at("options").get_to(entry.options);
+        } else {
+            entry.options = GenerationOptions::FromFilename(entry.file).value_or(GenerationOptions());
+        }
+        j.at("file_size").get_to(entry.fileSize);
+        j.at("file_modified").get_to(entry.fileModified);
+    }
+
+    unsigned int numberOfCollisionsFromFilename(const string& filename) {
+        smatch matches;
+        if (regex_search(filename, matches, regex("-nColl([0-9]+)"))) {
+            return stoul(matches[1]);
+        }
+        return 0;
+    }
+
+    GenerationOptions generationOptionsOfFile(const fs::path& path) {
+        if (const auto options = GenerationOptions::FromFilename(path.filename().string())) {
+            return *options;
+        }
+        const fs::path jsonPath = path.string() + ".json";
+        if (fs::exists(jsonPath)) {
+            try {
+                const auto properties = nlohmann::json::parse(tools::readFile(jsonPath));
+                if (properties.contains("provenance") && properties["provenance"].contains("options")) {
+                    return properties["provenance"]["options"].get<GenerationOptions>();
+                }
+            } catch (const nlohmann::json::exception& e) {
+                cerr << "Warning: could not parse " << jsonPath << ": " << e.what() << endl;
+            }
+        }
+        return {};
+    }
+
+    vector<Entry> build(const fs::path& directory, const vector<Entry>& previous, bool verbose) {
+        map<string, const Entry*> previousByFile;
+        for (const auto& entry: previous) {
+            previousByFile[entry.file] = &entry;
+        }
+
+        vector<Entry> entries;
+        for (const auto& file: fs::recursive_directory_iterator(directory)) {
+            if (!file.is_regular_file() || file.path().extension() != ".gas" || fs::is_empty(file.path())) {
+                continue;
+            }
+
+            Entry entry;
+            entry.file = fs::relative(file.path(), directory).string();
+            entry.fileSize = file.file_size();
+            entry.fileModified = file.last_write_time().time_since_epoch().count();
+
+            const auto it = previousByFile.find(entry.file);
+            if (it != previousByFile.end() && it->second->fileSize == entry.fileSize && it->second->fileModified == entry.fileModified) {
+                entries.push_back(*it->second);
+                continue;
+            }
+
+            if (verbose) {
+                cout << "Indexing " << file.path() << endl;
+            }
+
+            string error;
+            const auto gas = Gas::FromFile(file.path(), &error);
+            if (!gas) {
+                cerr << "Warning: " << error << " (will not be indexed)" << endl;
+                continue;
+            }
+
+            const auto components = gas->GetComponents();
+            vector<pair<string, double>> componentPairs;
+            for (size_t i = 0; i < components.first.size(); i++) {
+                componentPairs.emplace_back(components.first[i], components.second[i]);
+            }
+            tie(entry.components, entry.fractions) = normalizeComponents(componentPairs);
+            entry.temperature = gas->GetTemperature();
+            entry.pressure = gas->GetPressure();
+
+            const auto electricField = gas->GetTableElectricFieldView();
+            entry.numberOfElectricFieldValues = electricField.size();
+            if (!electricField.empty()) {
+                entry.electricFieldMin = *min_element(electricField.begin(), electricField.end());
+                entry.electricFieldMax = *max_element(electricField.begin(), electricField.end());
+            }
+            entry.numberOfCollisions = numberOfCollisionsFromFilename(file.path().filename().string());
+            entry.options = generationOptionsOfFile(file.path());
+
+            entries.push_back(entry);
+        }
+
+        sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.file < b.file; });
+        return entries;
+    }
+
+    bool write(const fs::path& indexFile, const vector<Entry>& entries) {
+        ofstream file(indexFile);
+        file << nlohmann::json{{"entries", entries}}.dump();
+        return bool(file);
+    }
+
+    optional<vector<Entry>> read(const fs::path& indexFile) {
+        ifstream file(indexFile);
+        if (!file) {
+            return nullopt;
+        }
+        try {
+            return nlohmann::json::parse(file).at("entries").get<vector<Entry>>();
+        } catch (const nlohmann::json::exception& e) {
+            cerr << "Error: could not parse catalog " << indexFile << ": " << e.what() << endl;
+            return nullopt;
+        }
+    }
+
+    double distance(const Entry& entry, const Query& query) {
+        if (!sameComponents(entry, query) || entry.options != query.options || entry.pressure <= 0 || query.pressure <= 0) {
+            return numeric_limits<double>::infinity();
+        }
+        const auto difference = subtract(coordinates(entry), coordinates(query));
+        return sqrt(dot(difference, difference));
+    }
+
+    vector<pair<double, const Entry*>> nearest(const vector<Entry>& entries, const Query& query, size_t count) {
+        vector<pair<double, const Entry*>> result;
+        for (const auto& entry: entries) {
+            const double d = distance(entry, query);
+            if (isfinite(d)) {
+                result.emplace_back(d, &entry);
+            }
+        }
+        sort(result.begin(), result.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        if (result.size() > count) {
+            result.resize(count);
+        }
+        return result;
+    }
+
+    optional<Bracket> bracket(const vector<Entry>& entries, const Query& query, double tolerance) {
+        vector<pair<const Entry*, vector<double>>> candidates;
+        for (const auto& entry: entries) {
+            if (isfinite(distance(entry, query))) {
+                candidates.emplace_back(&entry, coordinates(entry));
+            }
+        }
+        const auto target = coordinates(query);
+
+        optional<Bracket> result;
+        double shortest = numeric_limits<double>::infinity();
+        for (size_t i = 0; i < candidates.size(); i++) {
+            for (size_t j = i + 1; j < candidates.size(); j++) {
+                const auto segment = subtract(candidates[j].second, candidates[i].second);
+                const double length2 = dot(segment, segment);
+                if (length2 == 0 || sqrt(length2) >= shortest) {
+                    continue;
+                }
+                const auto fromI = subtract(target, candidates[i].second);
+                const double position = dot(fromI, segment) / length2;
+                if (position < 0 || position > 1) {
+                    continue;
+                }
+                // component of the query perpendicular to the segment
+                auto offset = fromI;
+                for (size_t k = 0; k < offset.size(); k++) {
+                    offset[k] -= position * segment[k];
+                }
+                const double offLineDistance = sqrt(dot(offset, offset));
+                if (offLineDistance > tolerance) {
+                    continue;
+                }
+
+                shortest = sqrt(length2);
+                if (position <= 0.5) {
+                    result = Bracket{candidates[i].first, candidates[j].first, position, offLineDistance};
+                } else {
+                    result = Bracket{candidates[j].first, candidates[i].first, 1 - position, offLineDistance};
+                }
+            }
+        }
+        return result;
+    }
+
+    nlohmann::json interpolate(const Gas& a, const Gas& b, double weight, const vector<double>& electricField) {
+        nlohmann::json j;
+        j["electric_field"] = electricField;
+        for (const auto& [name, property]: properties) {
+            vector<double> values(electricField.size());
+            for (size_t i = 0; i < electricField.size(); i++) {
+                values[i] = (1 - weight) * property(a, electricField[i]) + weight * property(b, electricField[i]);
+            }
+            if (any_of(values.begin(), values.end(), [](double value) { return value != 0; })) {
+                j[name] = values;
+            }
+        }
+        return j;
+    }
+} // namespace catalog
@@ -0,0 +1,103 @@
+#include "Export.h"
+
+#include "Gas.h"
+
+#include <cctype>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+using namespace std;
+
+namespace exporter {
+    namespace {
+        /// "electron_drift_velocity" -> "ElectronDriftVelocity"
+        string camelCase(const string& name) {
+            string result;
+            bool upper = true;
+            for (const char c: name) {
+                if (c == '_') {
+                    upper = true;
+                    continue;
+                }
+                result += upper ? char(toupper(c)) : c;
+                upper = false;
+            }
+            return result;
+        }
+
+        void writeArray(ostringstream& out, const string& type, const string& name, const vector<double>& values, const string& comment) {
+            out << "    /// " << comment << "\n";
+            out << "    inline constexpr " << type << " " << name << "[] = {";
+            for (size_t i = 0; i < values.size(); i++) {
+                out << (i % 4 == 0 ? "\n            " : " ") << values[i] << (i + 1 < values.size() ? "," : "");
+            }
+            out << "\n    };\n";
+        }
+    } // namespace
+
+    string identifier(const string& name) {
+        string result = "gas_";
+        for (const char c: name) {
+            result += isalnum(static_cast<unsigned char>(c)) ? c : '_';
+        }
+        return result;
+    }
+
+    string cppHeader(const Gas& gas, const string& namespaceName, const string& source) {
+        const auto& table = gas.GetTable();
+        const auto components = gas.GetComponents();
+
+        ostringstream out;
+        out << setprecision(17);
+
+        out << "// Generated by gas-cli (https://github.com/lobis/gas-cli)" << (source.empty() ? "" : " from " + source) << ". Do not edit\n";
+        out << "#pragma once\n\n";
+        out << "#include <cstddef>\n\n";
+        out << "#include \"TableInterpolation.h\"\n\n";
+        // inline variables (C++17): a single copy of the data in the program even if included in several translation units
+        out << "namespace " << namespaceName << " {\n";
+
+        out << "    inline constexpr const char* name = \"" << gas.GetName() << "\";\n";
+        out << "    /// Celsius\n";
+        out << "    inline constexpr double temperature = " << gas.GetTemperature() << ";\n";
+        out << "    /// bar\n";
+        out << "    inline constexpr double pressure = " << gas.GetPressure() << ";\n";
+        out << "    inline constexpr const char* components[] = {";
+        for (size_t i = 0; i < components.first.size(); i++) {
+            out << (i > 0 ? ", " : "") << "\"" << components.first[i] << "\"";
+        }
+        out << "};\n";
+        out << "    inline constexpr double fractions[] = {";
+        for (size_t i = 0; i < components.second.size(); i++) {
+            out << (i > 0 ? ", " : "") << components.second[i];
+        }
+        out << "};\n\n";
+
+        out << "    inline constexpr std::size_t size = " << table.electricField.size() << ";\n\n";
+
+        const map<string, string> units = {
+                {"electron_drift_velocity", "cm/us"},
+                {"electron_transversal_diffusion", "cm^(1/2)"},
+                {"electron_longitudinal_diffusion", "cm^(1/2)"},
+                {"electron_townsend", "1/cm"},
+                {"electron_attachment", "1/cm"},
+        };
+
+        writeArray(out, "double", "electric_field", table.electricField, "V/cm");
+        const auto properties = table.GetProperties();
+        for (const auto& [property, values]: properties) {
+            writeArray(out, "double", property, *values, units.at(property));
+        }
+        out << "\n";
+
+        out << "    /// Linear interpolation in the table, electric field in V/cm (clamped to the table range)\n";
+        for (const auto& [property, values]: properties) {
+            out << "    constexpr double " << camelCase(property) << "(double electricField) { return gastable::interpolate(electric_field, " << property << ", electricField); }\n";
+        }
+
+        out << "} // namespace " << namespaceName << "\n";
+
+        return out.str();
+    }
+} // namespace exporter
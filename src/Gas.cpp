@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <stdexcept>
 #include <string>
 #include <thread>
 
@@ -18,23 +19,18 @@ Gas::Gas() : gas(make_unique<MediumMagboltz>()) {}
 
 Gas::Gas(const string& gasFilepath) : gas(make_unique<MediumMagboltz>()) {
     if (!gas->LoadGasFile(gasFilepath)) {
-        cerr << "gas file not found: " << gasFilepath << endl;
-        exit(1);
+        throw runtime_error("gas file not found: " + gasFilepath);
     }
+    UpdateTable();
 }
 
 Gas::Gas(std::vector<std::pair<std::string, double>> components) {
-
-    if (components.empty()) {
-        cerr << "Error: cannot initialize gas with empty components" << endl;
-        exit(1);
+    const string error = ValidateComponents(components);
+    if (!error.empty()) {
+        throw runtime_error(error);
     }
 
     constexpr unsigned int componentsLimit = 6;
-    if (components.size() > componentsLimit) {
-        cerr << "Error: cannot initialize gas more than 6 components" << endl;
-        exit(1);
-    }
 
     // sort components by fraction
     sort(components.begin(), components.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
@@ -57,20 +53,60 @@ Gas::Gas(std::vector<std::pair<std::string, double>> components) {
                                       components[5].first, components[5].second);
 }
 
+string Gas::ValidateComponents(const vector<pair<string, double>>& components) {
+    if (components.empty()) {
+        return "Error: cannot initialize gas with empty components";
+    }
+
+    constexpr unsigned int componentsLimit = 6;
+    if (components.size() > componentsLimit) {
+        return "Error: cannot initialize gas more than 6 components";
+    }
+
+    return "";
+}
+
+optional<Gas> Gas::FromFile(const string& gasFilepath, string* error) {
+    Gas gas;
+    if (!gas.gas->LoadGasFile(gasFilepath)) {
+        if (error) {
+            *error = "gas file not found: " + gasFilepath;
+        }
+        return nullopt;
+    }
+    gas.UpdateTable();
+    return gas;
+}
+
+optional<Gas> Gas::FromComponents(vector<pair<string, double>> components, string* error) {
+    const string validationError = ValidateComponents(components);
+    if (!validationError.empty()) {
+        if (error) {
+            *error = validationError;
+        }
+        return nullopt;
+    }
+    return Gas(std::move(components));
+}
+
 void Gas::Generate(vector<double> electricFieldValues, unsigned int numberOfCollisions, bool verbose) {
     sort(electricFieldValues.begin(), electricFieldValues.end());
 
     // TODO: remove very close E field values
-    gas->SetFieldGrid(electricFieldValues, {0.0}, {HalfPi});
-
-    gas->EnableThermalMotion();
-    // gas->EnablePenningTransfer()
+    backend->Generate(*this, electricFieldValues, numberOfCollisions, verbose);
+    UpdateTable();
+}
 
-    gas->GenerateGasTable(int(numberOfCollisions), verbose);
+bool Gas::ApplyPenningTransfer(double rate) {
+    if (!backend->ApplyPenningTransfer(*this, rate)) {
+        return false;
+    }
+    UpdateTable();
+    return true;
 }
 
-void Gas::Write(const string& filename) const {
-    gas->WriteGasFile(filename);
+bool Gas::Write(const string& filename) const {
+    return gas->WriteGasFile(filename);
 }
 
 string Gas::GetName() const {
@@ -176,6 +212,135 @@ vector<double> Gas::GetTableElectricField() const {
     return electricField;
 }
 
+vector<pair<string, vector<double>*>> GasTable::GetProperties() {
+    return {
+            {"electron_drift_velocity", &electronDriftVelocity},
+            {"electron_transversal_diffusion", &electronTransversalDiffusion},
+            {"electron_longitudinal_diffusion", &electronLongitudinalDiffusion},
+            {"electron_townsend", &electronTownsend},
+            {"electron_attachment", &electronAttachment},
+    };
+}
+
+vector<pair<string, const vector<double>*>> GasTable::GetProperties() const {
+    return {
+            {"electron_drift_velocity", &electronDriftVelocity},
+            {"electron_transversal_diffusion", &electronTransversalDiffusion},
+            {"electron_longitudinal_diffusion", &electronLongitudinalDiffusion},
+            {"electron_townsend", &electronTownsend},
+            {"electron_attachment", &electronAttachment},
+    };
+}
+
+void Gas::UpdateTable() {
+    table = GasTable();
+    vector<double> magneticField, angle;
+    gas->GetFieldGrid(table.electricField, magneticField, angle);
+
+    for (const auto& [name, values]: table.GetProperties()) {
+        values->resize(table.electricField.size(), 0);
+    }
+    // garfield returns false (and leaves the value untouched) for tables that have not been filled
+    for (size_t i = 0; i < table.electricField.size(); i++) {
+        gas->GetElectronVelocityE(i, 0, 0, table.electronDriftVelocity[i]);
+        table.electronDriftVelocity[i] *= 1.E3; // cm/ns -> cm/us
+        gas->GetElectronTransverseDiffusion(i, 0, 0, table.electronTransversalDiffusion[i]);
+        gas->GetElectronLongitudinalDiffusion(i, 0, 0, table.electronLongitudinalDiffusion[i]);
+        gas->GetElectronTownsend(i, 0, 0, table.electronTownsend[i]);
+        gas->GetElectronAttachment(i, 0, 0, table.electronAttachment[i]);
+    }
+}
+
+vector<string> Gas::GetTablesNotInGasTable() const {
+    vector<string> tables;
+
+    vector<double> electricField, magneticField, angle;
+    gas->GetFieldGrid(electricField, magneticField, angle);
+    if (magneticField.size() > 1 || angle.size() > 1) {
+        tables.emplace_back("magnetic field / angle entries");
+    }
+    double ionMobility = 0;
+    if (!electricField.empty() && gas->GetIonMobility(0, 0, 0, ionMobility)) {
+        tables.emplace_back("ion mobility");
+    }
+    // needed to apply Penning transfer to the table
+    if (gas->GetNumberOfExcitationLevels() > 0) {
+        tables.emplace_back("excitation rates");
+    }
+    if (gas->GetNumberOfIonisationLevels() > 0) {
+        tables.emplace_back("ionisation rates");
+    }
+    return tables;
+}
+
+bool Gas::SetTable(const GasTable& newTable) {
+    const size_t n = newTable.electricField.size();
+    for (const auto& [name, values]: newTable.GetProperties()) {
+        if (values->size() != n) {
+            cerr << "Error: table property '" << name << "' has " << values->size() << " values but there are " << n << " electric field values" << endl;
+            return false;
+        }
+    }
+
+    for (const auto& discarded: GetTablesNotInGasTable()) {
+        cerr << "Warning: " << discarded << " of the gas table will be discarded" << endl;
+    }
+
+    gas->ResetTables();
+    if (!gas->SetFieldGrid(newTable.electricField, {0.0}, {HalfPi})) {
+        return false;
+    }
+
+    bool ok = true;
+    auto setProperty = [&](const vector<double>& values, auto setter, double scale = 1.0) {
+        if (all_of(values.begin(), values.end(), [](double value) { return value == 0; })) {
+            return;
+        }
+        for (size_t i = 0; i < n; i++) {
+            ok &= (gas.get()->*setter)(i, 0, 0, values[i] * scale);
+        }
+    };
+
+    setProperty(newTable.electronDriftVelocity, &MediumMagboltz::SetElectronVelocityE, 1.E-3); // cm/us -> cm/ns
+    setProperty(newTable.electronTransversalDiffusion, &MediumMagboltz::SetElectronTransverseDiffusion);
+    setProperty(newTable.electronLongitudinalDiffusion, &MediumMagboltz::SetElectronLongitudinalDiffusion);
+    setProperty(newTable.electronTownsend, &MediumMagboltz::SetElectronTownsend);
+    setProperty(newTable.electronAttachment, &MediumMagboltz::SetElectronAttachment);
+
+    UpdateTable();
+    return ok;
+}
+
+optional<Gas> Gas::SelectElectricFieldValues(const vector<size_t>& indices) const {
+    // Garfield cannot remove electric field values: edit the gas file
+    const tools::TemporaryFile file;
+    if (!Write(file.GetPath())) {
+        return nullopt;
+    }
+    const auto selected = tools::selectGasFileElectricFieldValues(tools::readFile(file.GetPath()), indices);
+    if (!selected) {
+        return nullopt;
+    }
+    auto gas = FromFile(tools::TemporaryFile(*selected).GetPath());
+    if (gas) {
+        gas->SetBackend(backend);
+    }
+    return gas;
+}
+
+GasTable Gas::GetInterpolatedTable(const vector<double>& electricField) const {
+    GasTable result;
+    result.electricField = electricField;
+    for (const double e: electricField) {
+        result.electronDriftVelocity.push_back(GetElectronDriftVelocity(e));
+        result.electronTransversalDiffusion.push_back(GetElectronTransversalDiffusion(e));
+        result.electronLongitudinalDiffusion.push_back(GetElectronLongitudinalDiffusion(e));
+        result.electronTownsend.push_back(GetElectronTownsend(e));
+        result.electronAttachment.push_back(GetElectronAttachment(e));
+    }
+    return result;
+}
+
 nlohmann::json Gas::GetGasPropertiesJson(const vector<double>& electricFieldMaybeEmpty) const {
     nlohmann::json j;
 
@@ -204,6 +369,10 @@ nlohmann::json Gas::GetGasPropertiesJson(const vector<double>& electricFieldMayb
                 cerr << "Warning: electric field value '" << e << "' is outside the range of the gas table (" << min << ", " << max << ")" << endl;
             }
         }
+        if (electricField.empty()) {
+            throw runtime_error("Error: no electric field values fit in the range of the gas table (" + to_string(min) + ", " + to_string(max) + ")");
+        }
+
         tools::removeSimilarElements(electricField);
         if (tools::similar(electricField.front(), min)) {
             electricField.push_back(min);
@@ -213,11 +382,6 @@ nlohmann::json Gas::GetGasPropertiesJson(const vector<double>& electricFieldMayb
             electricField.push_back(max);
             sort(electricField.begin(), electricField.end());
         }
-
-        if (electricField.empty()) {
-            cerr << "Error: no electric field values fit in the range of the gas table (" << min << ", " << max << ")" << endl;
-            exit(1);
-        }
     }
 
     j["electric_field"] = electricField;
@@ -266,5 +430,7 @@ nlohmann::json Gas::GetGasPropertiesJson(const vector<double>& electricFieldMayb
 }
 
 bool Gas::Merge(const string& gasFile, bool replaceOld) {
-    return gas->MergeGasFile(gasFile, replaceOld);
+    const bool ok = gas->MergeGasFile(gasFile, replaceOld);
+    UpdateTable();
+    return ok;
 }
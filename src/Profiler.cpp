@@ -0,0 +1,310 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <filesystem>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#if defined(__linux__) && !defined(sigev_notify_thread_id)
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+using namespace std;
+
+namespace profiler {
+    namespace {
+        constexpr int maxDepth = 64;
+        constexpr size_t bufferSize = 4096;
+        // frames of the signal handler itself: the handler and the signal trampoline
+        constexpr int skippedFrames = 2;
+
+        struct Sample {
+            int depth = 0;
+            void* frames[maxDepth];
+        };
+
+        // ring buffer written by the signal handler (single producer) and read by the collector thread (single consumer)
+        Sample buffer[bufferSize];
+        atomic<size_t> head{0};
+        atomic<size_t> tail{0};
+        atomic<size_t> dropped{0};
+        atomic<long long> handlerNanoseconds{0};
+        atomic<bool> running{false};
+        atomic<long> sampledThread{0};
+
+        // stacks (raw addresses, top of the stack first) and their number of samples
+        map<vector<void*>, size_t> stacks;
+        mutex stacksMutex;
+        thread collector;
+        atomic<bool> collecting{false};
+
+        bool threadTimer = false;
+#ifdef __linux__
+        timer_t timer;
+#endif
+        clockid_t cpuClock;
+        long long cpuNanoseconds = 0;
+
+        long long nanoseconds(clockid_t clock) {
+            timespec time{};
+            clock_gettime(clock, &time);
+            return time.tv_sec * 1000000000LL + time.tv_nsec;
+        }
+
+        long currentThread() { return syscall(SYS_gettid); }
+
+        // only async-signal-safe calls in here ('backtrace' is once libgcc is loaded, see 'start')
+        void handler(int) {
+            const int savedErrno = errno;
+            // the process-wide fallback timer also interrupts other threads
+            if (running.load(memory_order_relaxed) && currentThread() == sampledThread.load(memory_order_relaxed)) {
+                const long long begin = nanoseconds(CLOCK_THREAD_CPUTIME_ID);
+
+                const size_t position = head.load(memory_order_relaxed);
+                if (position - tail.load(memory_order_acquire) >= bufferSize) {
+                    dropped.fetch_add(1, memory_order_relaxed);
+                } else {
+                    void* frames[maxDepth + skippedFrames];
+                    const int depth = backtrace(frames, maxDepth + skippedFrames) - skippedFrames;
+                    Sample& sample = buffer[position % bufferSize];
+                    sample.depth = max(depth, 0);
+                    memcpy(sample.frames, frames + skippedFrames, sample.depth * sizeof(void*));
+                    head.store(position + 1, memory_order_release);
+                }
+
+                handlerNanoseconds.fetch_add(nanoseconds(CLOCK_THREAD_CPUTIME_ID) - begin, memory_order_relaxed);
+            }
+            errno = savedErrno;
+        }
+
+        void drain() {
+            lock_guard<mutex> lock(stacksMutex);
+            const size_t end = head.load(memory_order_acquire);
+            for (size_t position = tail.load(memory_order_relaxed); position < end; position++) {
+                const Sample& sample = buffer[position % bufferSize];
+                stacks[vector<void*>(sample.frames, sample.frames + sample.depth)]++;
+            }
+            tail.store(end, memory_order_release);
+        }
+
+        /// Demangled symbol name, or '[library]' if the symbol is not exported
+        string symbolName(void* address, bool returnAddress) {
+            // a return address may already belong to the next function
+            const auto lookup = static_cast<char*>(address) - (returnAddress ? 1 : 0);
+            Dl_info info{};
+            string name;
+            if (dladdr(lookup, &info) != 0 && info.dli_sname != nullptr) {
+                int status = 0;
+                char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+                name = status == 0 ? demangled : info.dli_sname;
+                free(demangled);
+            } else if (info.dli_fname != nullptr) {
+                // offsets would split a function into one entry per instruction
+                name = "[" + filesystem::path(info.dli_fname).filename().string() + "]";
+            } else {
+                name = "??";
+            }
+            // ';' separates frames in folded stacks
+            replace(name.begin(), name.end(), ';', ':');
+            return name;
+        }
+
+        /// Stacks with symbol names (root first) and their number of samples
+        vector<pair<vector<string>, size_t>> symbolizedStacks() {
+            lock_guard<mutex> lock(stacksMutex);
+            map<pair<void*, bool>, string> names;
+            vector<pair<vector<string>, size_t>> result;
+            for (const auto& [frames, count]: stacks) {
+                vector<string> stack;
+                for (size_t i = frames.size(); i-- > 0;) {
+                    const auto key = make_pair(frames[i], i > 0);
+                    auto name = names.find(key);
+                    if (name == names.end()) {
+                        name = names.emplace(key, symbolName(frames[i], i > 0)).first;
+                    }
+                    stack.push_back(name->second);
+                }
+                result.emplace_back(std::move(stack), count);
+            }
+            return result;
+        }
+    } // namespace
+
+    bool start(double frequency) {
+        if (running || frequency <= 0) {
+            return false;
+        }
+
+        {
+            lock_guard<mutex> lock(stacksMutex);
+            stacks.clear();
+        }
+        head = 0;
+        tail = 0;
+        dropped = 0;
+        handlerNanoseconds = 0;
+        sampledThread = currentThread();
+
+        // the first call of 'backtrace' loads libgcc, which is not safe inside a signal handler
+        void* warmup[1];
+        backtrace(warmup, 1);
+
+        struct sigaction action {};
+        action.sa_handler = handler;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGPROF, &action, nullptr) != 0) {
+            return false;
+        }
+
+        const long long interval = max(1LL, static_cast<long long>(1E9 / frequency));
+        threadTimer = false;
+#ifdef __linux__
+        // CPU time of the calling thread only, signal delivered to that thread
+        sigevent event{};
+        event.sigev_notify = SIGEV_THREAD_ID;
+        event.sigev_signo = SIGPROF;
+        event.sigev_notify_thread_id = sampledThread;
+        if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &timer) == 0) {
+            itimerspec specification{};
+            specification.it_interval.tv_sec = interval / 1000000000LL;
+            specification.it_interval.tv_nsec = interval % 1000000000LL;
+            specification.it_value = specification.it_interval;
+            threadTimer = timer_settime(timer, 0, &specification, nullptr) == 0;
+            if (!threadTimer) {
+                timer_delete(timer);
+            }
+        }
+#endif
+        if (!threadTimer) {
+            // CPU time of the whole process, samples of other threads are discarded by the handler
+            itimerval value{};
+            value.it_interval.tv_sec = interval / 1000000000LL;
+            value.it_interval.tv_usec = max(1LL, (interval % 1000000000LL) / 1000);
+            value.it_value = value.it_interval;
+            if (setitimer(ITIMER_PROF, &value, nullptr) != 0) {
+                signal(SIGPROF, SIG_IGN);
+                return false;
+            }
+        }
+
+        pthread_getcpuclockid(pthread_self(), &cpuClock);
+        cpuNanoseconds = -nanoseconds(cpuClock);
+
+        running = true;
+        collecting = true;
+        collector = thread([]() {
+            while (collecting) {
+                drain();
+                this_thread::sleep_for(chrono::milliseconds(100));
+            }
+        });
+        return true;
+    }
+
+    void stop() {
+        if (!running) {
+            return;
+        }
+#ifdef __linux__
+        if (threadTimer) {
+            timer_delete(timer);
+        }
+#endif
+        if (!threadTimer) {
+            const itimerval disabled{};
+            setitimer(ITIMER_PROF, &disabled, nullptr);
+        }
+        cpuNanoseconds += nanoseconds(cpuClock);
+        running = false;
+        // a signal may still be pending, its default action would terminate the process
+        signal(SIGPROF, SIG_IGN);
+
+        collecting = false;
+        collector.join();
+        drain();
+    }
+
+    bool isRunning() { return running; }
+
+    size_t samples() {
+        drain();
+        lock_guard<mutex> lock(stacksMutex);
+        size_t total = 0;
+        for (const auto& [frames, count]: stacks) {
+            total += count;
+        }
+        return total;
+    }
+
+    size_t droppedSamples() { return dropped; }
+
+    double overhead() {
+        const long long sampled = running ? cpuNanoseconds + nanoseconds(cpuClock) : cpuNanoseconds;
+        return sampled > 0 ? double(handlerNanoseconds) / sampled : 0;
+    }
+
+    string foldedStacks() {
+        map<string, size_t> folded;
+        for (const auto& [stack, count]: symbolizedStacks()) {
+            string line;
+            for (const auto& name: stack) {
+                line += (line.empty() ? "" : ";") + name;
+            }
+            folded[line] += count;
+        }
+
+        ostringstream stream;
+        for (const auto& [line, count]: folded) {
+            stream << line << " " << count << "\n";
+        }
+        return stream.str();
+    }
+
+    string summary(size_t count) {
+        map<string, pair<size_t, size_t>> symbols; // self, total
+        size_t total = 0;
+        for (const auto& [stack, samples]: symbolizedStacks()) {
+            total += samples;
+            if (!stack.empty()) {
+                symbols[stack.back()].first += samples;
+            }
+            // recursive symbols are counted once per stack
+            for (const auto& name: set<string>(stack.begin(), stack.end())) {
+                symbols[name].second += samples;
+            }
+        }
+
+        vector<pair<string, pair<size_t, size_t>>> sorted(symbols.begin(), symbols.end());
+        sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+
+        ostringstream stream;
+        stream << "Samples: " << total << " (dropped: " << droppedSamples() << "), profiler overhead: " << fixed << setprecision(2) << 100 * overhead() << "%\n";
+        stream << setw(8) << "self" << setw(9) << "total" << "  symbol\n";
+        for (size_t i = 0; i < min(count, sorted.size()); i++) {
+            const auto& [name, counts] = sorted[i];
+            stream << setw(7) << 100.0 * counts.first / total << "%" << setw(8) << 100.0 * counts.second / total << "%  " << name << "\n";
+        }
+        return stream.str();
+    }
+} // namespace profiler
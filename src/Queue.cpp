@@ -0,0 +1,263 @@
+#include "Queue.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace fs = std::filesystem;
+
+namespace workqueue {
+    namespace {
+        const string pendingDirectory = "pending";
+        const string claimedDirectory = "claimed";
+        const string doneDirectory = "done";
+        const string failedDirectory = "failed";
+        const string resultsDirectory = "results";
+        // one empty file per task id ever used, never removed
+        const string idsDirectory = "ids";
+        const string taskExtension = ".json";
+        // number of failed attempts, stored with the parameters in the task file
+        const string attemptsKey = "failed_attempts";
+
+        fs::path taskPath(const fs::path& queue, const string& directory, const string& id) {
+            return queue / directory / (id + taskExtension);
+        }
+
+        /// Claimed tasks are named '<id>.<owner>.json' (ids never contain '.'), so only the owner finds its claim
+        fs::path claimedPath(const fs::path& queue, const Task& task) {
+            return queue / claimedDirectory / (task.id + "." + task.owner + taskExtension);
+        }
+
+        /// Task ids and files (sorted by id) in one of the queue subdirectories. Hidden files (being written) are skipped
+        vector<pair<string, fs::path>> taskFiles(const fs::path& queue, const string& directory) {
+            vector<pair<string, fs::path>> files;
+            error_code ec;
+            for (const auto& entry: fs::directory_iterator(queue / directory, ec)) {
+                const auto filename = entry.path().filename().string();
+                if (filename.empty() || filename[0] == '.' || entry.path().extension() != taskExtension) {
+                    continue;
+                }
+                const auto stem = entry.path().stem().string();
+                files.emplace_back(stem.substr(0, stem.find('.')), entry.path());
+            }
+            sort(files.begin(), files.end());
+            return files;
+        }
+
+        vector<string> taskIds(const fs::path& queue, const string& directory) {
+            vector<string> ids;
+            for (const auto& [id, path]: taskFiles(queue, directory)) {
+                ids.push_back(id);
+            }
+            return ids;
+        }
+
+        /// Unique per claim, also when the same worker claims a task again after its lease expired
+        string claimToken(const string& worker) {
+            random_device device;
+            ostringstream token;
+            token << worker << "-" << hex << setw(8) << setfill('0') << device();
+            return token.str();
+        }
+
+        bool move(const fs::path& from, const fs::path& to) {
+            // rename is atomic: if several workers try to move the same file only one succeeds.
+            // Ids are unique, so the target never exists
+            error_code ec;
+            fs::rename(from, to, ec);
+            return !ec;
+        }
+
+        string formatId(size_t number) {
+            ostringstream id;
+            id << "task-" << setw(6) << setfill('0') << number;
+            return id.str();
+        }
+
+        enum class Reservation { Reserved, Taken, Failed };
+
+        /// Exclusive creation succeeds for only one caller (on any node), so concurrent enqueues never share an id
+        Reservation reserve(const fs::path& queue, const string& id) {
+            const int file = open((queue / idsDirectory / id).c_str(), O_CREAT | O_EXCL | O_WRONLY, 0644);
+            if (file < 0) {
+                return errno == EEXIST ? Reservation::Taken : Reservation::Failed;
+            }
+            close(file);
+            // queues created before ids were reserved
+            for (const auto& directory: {pendingDirectory, claimedDirectory, doneDirectory}) {
+                if (fs::exists(taskPath(queue, directory, id))) {
+                    return Reservation::Taken;
+                }
+            }
+            return Reservation::Reserved;
+        }
+    } // namespace
+
+    vector<string> enqueue(const fs::path& queue, const vector<nlohmann::json>& tasks) {
+        for (const auto& directory: {pendingDirectory, claimedDirectory, doneDirectory, failedDirectory, resultsDirectory, idsDirectory}) {
+            fs::create_directories(queue / directory);
+        }
+
+        // only a starting point, taken ids are skipped
+        size_t next = 0;
+        error_code ec;
+        for (auto entry = fs::directory_iterator(queue / idsDirectory, ec); !ec && entry != fs::directory_iterator(); entry.increment(ec)) {
+            next++;
+        }
+
+        vector<string> ids;
+        for (const auto& parameters: tasks) {
+            string id;
+            Reservation reservation = Reservation::Taken;
+            while (reservation == Reservation::Taken) {
+                id = formatId(next++);
+                reservation = reserve(queue, id);
+            }
+            if (reservation == Reservation::Failed) {
+                cerr << "Error: could not reserve a task id in " << queue << ": " << strerror(errno) << endl;
+                break;
+            }
+
+            // write to a hidden file first so workers never read partial tasks. 'link' (same directory, also on AFS)
+            // fails instead of replacing an existing task
+            const fs::path temporary = queue / pendingDirectory / ("." + id + taskExtension);
+            {
+                ofstream file(temporary);
+                file << parameters.dump();
+            }
+            const bool published = link(temporary.c_str(), taskPath(queue, pendingDirectory, id).c_str()) == 0;
+            const int linkError = errno;
+            fs::remove(temporary, ec);
+            if (!published) {
+                cerr << "Error: could not enqueue task '" << id << "' in " << queue << ": " << strerror(linkError) << endl;
+                continue;
+            }
+            ids.push_back(id);
+        }
+        return ids;
+    }
+
+    optional<Task> claim(const fs::path& queue, const string& worker) {
+        for (const auto& id: taskIds(queue, pendingDirectory)) {
+            Task task{id, claimToken(worker), {}};
+            const auto pending = taskPath(queue, pendingDirectory, id);
+            const auto claimed = claimedPath(queue, task);
+
+            // rename keeps the modification time, refresh it first so the lease starts now
+            error_code ec;
+            fs::last_write_time(pending, fs::file_time_type::clock::now(), ec);
+            if (ec || !move(pending, claimed)) {
+                // claimed by another worker in the meantime
+                continue;
+            }
+
+            ifstream file(claimed);
+            try {
+                file >> task.parameters;
+            } catch (const nlohmann::json::exception& e) {
+                cerr << "Error: could not parse task '" << id << "': " << e.what() << endl;
+                move(claimed, taskPath(queue, doneDirectory, id));
+                continue;
+            }
+            if (task.parameters.is_object() && task.parameters.contains(attemptsKey)) {
+                task.attempts = task.parameters[attemptsKey];
+                task.parameters.erase(attemptsKey);
+            }
+            return task;
+        }
+        return nullopt;
+    }
+
+    bool heartbeat(const fs::path& queue, const Task& task) {
+        error_code ec;
+        fs::last_write_time(claimedPath(queue, task), fs::file_time_type::clock::now(), ec);
+        return !ec;
+    }
+
+    bool complete(const fs::path& queue, const Task& task) {
+        return move(claimedPath(queue, task), taskPath(queue, doneDirectory, task.id));
+    }
+
+    bool release(const fs::path& queue, const Task& task) {
+        return move(claimedPath(queue, task), taskPath(queue, pendingDirectory, task.id));
+    }
+
+    bool fail(const fs::path& queue, const Task& task, unsigned int maxAttempts) {
+        // hide the claim first: from then on no other worker looks at it, so it can be rewritten safely
+        const fs::path hidden = queue / claimedDirectory / ("." + claimedPath(queue, task).filename().string());
+        if (!move(claimedPath(queue, task), hidden)) {
+            return false;
+        }
+        auto content = task.parameters;
+        content[attemptsKey] = task.attempts + 1;
+        {
+            ofstream file(hidden);
+            file << content.dump();
+        }
+        // queues created before failed tasks were kept
+        error_code ec;
+        fs::create_directories(queue / failedDirectory, ec);
+        const bool retry = task.attempts + 1 < maxAttempts;
+        return move(hidden, taskPath(queue, retry ? pendingDirectory : failedDirectory, task.id));
+    }
+
+    size_t requeueExpired(const fs::path& queue, chrono::seconds lease) {
+        size_t requeued = 0;
+        const auto now = fs::file_time_type::clock::now();
+        for (const auto& [id, claimed]: taskFiles(queue, claimedDirectory)) {
+            error_code ec;
+            const auto lastHeartbeat = fs::last_write_time(claimed, ec);
+            if (ec || now - lastHeartbeat <= lease) {
+                continue;
+            }
+            if (move(claimed, taskPath(queue, pendingDirectory, id))) {
+                cerr << "Warning: lease of task '" << id << "' expired, it will be processed again" << endl;
+                requeued++;
+            }
+        }
+        return requeued;
+    }
+
+    size_t countPending(const fs::path& queue) {
+        return taskIds(queue, pendingDirectory).size();
+    }
+
+    size_t countClaimed(const fs::path& queue) {
+        return taskIds(queue, claimedDirectory).size();
+    }
+
+    size_t countDone(const fs::path& queue) {
+        return taskIds(queue, doneDirectory).size();
+    }
+
+    size_t countFailed(const fs::path& queue) {
+        return taskIds(queue, failedDirectory).size();
+    }
+
+    fs::path resultPath(const fs::path& queue, const Task& task) {
+        return queue / resultsDirectory / (task.id + ".gas");
+    }
+
+    vector<fs::path> results(const fs::path& queue) {
+        vector<fs::path> files;
+        error_code ec;
+        for (const auto& entry: fs::directory_iterator(queue / resultsDirectory, ec)) {
+            const auto filename = entry.path().filename().string();
+            if (!filename.empty() && filename[0] != '.' && entry.path().extension() == ".gas") {
+                files.push_back(entry.path());
+            }
+        }
+        sort(files.begin(), files.end());
+        return files;
+    }
+} // namespace workqueue
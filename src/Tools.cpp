@@ -1,7 +1,16 @@
 
 #include "Tools.h"
 
+#include <cerrno>
+#include <cstdlib>
 #include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <sys/wait.h>
+#include <unistd.h>
 
 using namespace std;
 
@@ -72,12 +81,520 @@ namespace tools {
         sort(values.begin(), values.end());
     }
 
+    double interpolateLinear(double x0, double y0, double x1, double y1, double x) {
+        if (x1 == x0) {
+            return y0;
+        }
+        return y0 + (y1 - y0) * (x - x0) / (x1 - x0);
+    }
+
+    double relativeError(double value, double reconstructed) {
+        return abs(reconstructed - value) / max(abs(value), 1E-20);
+    }
+
+    vector<size_t> compactIndices(const vector<double>& x, const vector<vector<double>>& ys, double relTol) {
+        const size_t n = x.size();
+        if (n <= 2) {
+            vector<size_t> all(n);
+            for (size_t i = 0; i < n; i++) { all[i] = i; }
+            return all;
+        }
+
+        // checks if all points strictly between 'first' and 'last' can be reconstructed from these two
+        auto segmentOk = [&](size_t first, size_t last) {
+            for (const auto& y: ys) {
+                for (size_t i = first + 1; i < last; i++) {
+                    const double reconstructed = interpolateLinear(x[first], y[first], x[last], y[last], x[i]);
+                    if (relativeError(y[i], reconstructed) > relTol) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        };
+
+        // greedy: extend the current segment as far as possible, keep the last point that still worked
+        vector<size_t> kept = {0};
+        size_t anchor = 0;
+        for (size_t i = 1; i < n - 1; i++) {
+            if (!segmentOk(anchor, i + 1)) {
+                kept.push_back(i);
+                anchor = i;
+            }
+        }
+        kept.push_back(n - 1);
+
+        return kept;
+    }
+
+    double maxReconstructionError(const vector<double>& x, const vector<double>& y, const vector<size_t>& keptIndices) {
+        double maxError = 0;
+        for (size_t k = 1; k < keptIndices.size(); k++) {
+            const size_t first = keptIndices[k - 1];
+            const size_t last = keptIndices[k];
+            for (size_t i = first + 1; i < last; i++) {
+                const double reconstructed = interpolateLinear(x[first], y[first], x[last], y[last], x[i]);
+                maxError = max(maxError, relativeError(y[i], reconstructed));
+            }
+        }
+        return maxError;
+    }
+
+    vector<double> localFitPrediction(const vector<double>& x, const vector<double>& y, unsigned int window, const vector<bool>& excluded) {
+        const size_t n = x.size();
+        vector<double> prediction(y);
+
+        auto isExcluded = [&excluded](size_t j) { return j < excluded.size() && excluded[j]; };
+
+        for (size_t i = 0; i < n; i++) {
+            // zeros (e.g. Townsend coefficient below threshold) would turn the log fit of a positive point into a linear one
+            auto isNeighbour = [&](size_t j) { return !isExcluded(j) && (y[i] <= 0 || y[j] > 0); };
+
+            vector<size_t> neighbours;
+            for (size_t j = i, found = 0; j > 0 && found < window;) {
+                if (isNeighbour(--j)) {
+                    neighbours.push_back(j);
+                    found++;
+                }
+            }
+            for (size_t j = i + 1, found = 0; j < n && found < window; j++) {
+                if (isNeighbour(j)) {
+                    neighbours.push_back(j);
+                    found++;
+                }
+            }
+            if (neighbours.size() < 2) {
+                continue;
+            }
+
+            // transport properties are close to power laws: fit in log-log scale when possible
+            bool logX = x[i] > 0, logY = true;
+            for (const size_t j: neighbours) {
+                logX &= x[j] > 0;
+                logY &= y[j] > 0;
+            }
+
+            auto t = [&](size_t j) { return logX ? log(x[j]) - log(x[i]) : x[j] - x[i]; };
+            auto u = [&](size_t j) { return logY ? log(y[j]) : y[j]; };
+
+            // centered at the point so the prediction is the constant term. Quadratic if there are enough neighbours
+            const size_t terms = neighbours.size() >= 4 ? 3 : 2;
+            double a[3][4] = {};
+            for (const size_t j: neighbours) {
+                const double powers[3] = {1, t(j), t(j) * t(j)};
+                for (size_t r = 0; r < terms; r++) {
+                    for (size_t c = 0; c < terms; c++) {
+                        a[r][c] += powers[r] * powers[c];
+                    }
+                    a[r][3] += powers[r] * u(j);
+                }
+            }
+
+            // gaussian elimination with partial pivoting
+            bool singular = false;
+            for (size_t c = 0; c < terms && !singular; c++) {
+                size_t pivot = c;
+                for (size_t r = c + 1; r < terms; r++) {
+                    if (abs(a[r][c]) > abs(a[pivot][c])) { pivot = r; }
+                }
+                if (abs(a[pivot][c]) < 1E-300) {
+                    singular = true;
+                    break;
+                }
+                swap(a[c], a[pivot]);
+                for (size_t r = 0; r < terms; r++) {
+                    if (r == c) { continue; }
+                    const double factor = a[r][c] / a[c][c];
+                    for (size_t k = c; k < 4; k++) {
+                        a[r][k] -= factor * a[c][k];
+                    }
+                }
+            }
+            if (!singular) {
+                const double value = a[0][3] / a[0][0];
+                prediction[i] = logY ? exp(value) : value;
+            }
+        }
+
+        return prediction;
+    }
+
+    vector<size_t> findOutliers(const vector<double>& x, const vector<double>& y, unsigned int window, double threshold, double minRelativeDeviation) {
+        const size_t n = y.size();
+        auto median = [](vector<double> values) {
+            if (values.empty()) { return 0.0; }
+            const size_t middle = values.size() / 2;
+            nth_element(values.begin(), values.begin() + middle, values.end());
+            return values[middle];
+        };
+
+        // zeros next to zeros are a legitimately zero region (below threshold), not zeroed points
+        vector<bool> zeroRegion(n);
+        for (size_t i = 0; i < n; i++) {
+            for (const int step: {-1, 1}) {
+                size_t found = 0, zeros = 0;
+                for (long j = long(i) + step; j >= 0 && j < long(n) && found < window; j += step) {
+                    found++;
+                    zeros += y[j] == 0;
+                }
+                zeroRegion[i] = zeroRegion[i] || (y[i] == 0 && found > 0 && zeros == found);
+            }
+        }
+
+        // only values fitted with neighbours on both sides can be judged: extrapolations (edges, first values after a
+        // zero region, steepest part of the curve) and non positive electric fields are never flagged
+        auto isJudged = [&](size_t i, const vector<bool>& excluded) {
+            if (x[i] <= 0 || zeroRegion[i]) {
+                return false;
+            }
+            for (size_t j = i > window ? i - window : 0; j <= min(i + window, n - 1); j++) {
+                if (zeroRegion[j]) {
+                    return false;
+                }
+            }
+            for (const int step: {-1, 1}) {
+                bool found = false;
+                for (long j = long(i) + step; j >= 0 && j < long(n) && !found; j += step) {
+                    found = !excluded[j] && (y[i] <= 0 || y[j] > 0);
+                }
+                if (!found) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        auto relativeResiduals = [&](const vector<bool>& excluded) {
+            const auto prediction = localFitPrediction(x, y, window, excluded);
+            vector<double> residuals(n);
+            for (size_t i = 0; i < n; i++) {
+                // log ratio does not saturate for large deviations, relative difference otherwise (zeroed values give -1)
+                residuals[i] = y[i] > 0 && prediction[i] > 0 ? log(y[i] / prediction[i]) : (y[i] - prediction[i]) / max({abs(prediction[i]), abs(y[i]), 1E-20});
+            }
+            return residuals;
+        };
+
+        // outliers distort the fit of their neighbours: test the worst value against the residuals of the other values
+        // fitted without it (with few points these are mostly fit error, not noise), flag it, fit again and repeat
+        vector<bool> flagged(n, false);
+        while (true) {
+            const auto residuals = relativeResiduals(flagged);
+            size_t worst = n;
+            for (size_t i = 0; i < n; i++) {
+                if (!flagged[i] && isJudged(i, flagged) && abs(residuals[i]) > minRelativeDeviation && (worst == n || abs(residuals[i]) > abs(residuals[worst]))) {
+                    worst = i;
+                }
+            }
+            if (worst == n) {
+                break;
+            }
+
+            auto excluded = flagged;
+            excluded[worst] = true;
+            const auto cleanResiduals = relativeResiduals(excluded);
+            vector<double> inliers;
+            for (size_t i = 0; i < n; i++) {
+                if (!excluded[i] && isJudged(i, excluded)) {
+                    inliers.push_back(cleanResiduals[i]);
+                }
+            }
+            const double center = median(inliers);
+            for (auto& value: inliers) {
+                value = abs(value - center);
+            }
+            // fit error depends on the curvature: the spread of the values next to it counts as well as the global one
+            vector<double> local;
+            for (size_t j = worst > window ? worst - window : 0; j <= min(worst + window, n - 1); j++) {
+                if (!excluded[j] && isJudged(j, excluded)) {
+                    local.push_back(abs(cleanResiduals[j] - center));
+                }
+            }
+            // MAD to standard deviation for gaussian noise. Exact values give no spread at all, every deviation above
+            // 'minRelativeDeviation' would be an outlier without a floor
+            const double sigma = max({1.4826 * median(inliers), 1.4826 * median(local), minRelativeDeviation / threshold});
+            if (abs(residuals[worst] - center) <= threshold * sigma) {
+                break;
+            }
+            flagged[worst] = true;
+        }
+
+        vector<size_t> outliers;
+        for (size_t i = 0; i < n; i++) {
+            if (flagged[i]) {
+                outliers.push_back(i);
+            }
+        }
+        return outliers;
+    }
+
+    vector<size_t> forkEach(size_t count, unsigned int jobs, const function<int(size_t)>& task) {
+        jobs = max(jobs, 1U);
+        // buffered output would otherwise be written by every child
+        cout.flush();
+        cerr.flush();
+
+        vector<size_t> failed;
+        map<pid_t, size_t> running;
+
+        auto waitForOne = [&]() {
+            int status = 0;
+            const pid_t pid = wait(&status);
+            if (pid <= 0) {
+                return;
+            }
+            const size_t index = running.at(pid);
+            running.erase(pid);
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                failed.push_back(index);
+            }
+        };
+
+        for (size_t i = 0; i < count; i++) {
+            while (running.size() >= jobs) {
+                waitForOne();
+            }
+
+            const pid_t pid = fork();
+            if (pid == 0) {
+                int result = 1;
+                try {
+                    result = task(i);
+                } catch (const exception& e) {
+                    cerr << "Error: " << e.what() << endl;
+                }
+                cout.flush();
+                cerr.flush();
+                // skip atexit handlers and destructors of the parent state
+                _exit(result);
+            } else if (pid < 0) {
+                cerr << "Error: could not fork process for task " << i << endl;
+                failed.push_back(i);
+                continue;
+            }
+            running[pid] = i;
+        }
+        while (!running.empty()) {
+            waitForOne();
+        }
+
+        sort(failed.begin(), failed.end());
+        return failed;
+    }
+
     void writeToFile(const string& filename, const string& content) {
         ofstream file(filename);
         file << content;
         file.close();
     }
 
+    string readFile(const string& filename) {
+        ifstream file(filename, ios::binary);
+        return readStream(file);
+    }
+
+    string readStream(istream& stream) {
+        ostringstream content;
+        content << stream.rdbuf();
+        return content.str();
+    }
+
+    int reserveStandardOutput() {
+        cout.flush();
+        fflush(stdout);
+        const int dataFileDescriptor = dup(STDOUT_FILENO);
+        dup2(STDERR_FILENO, STDOUT_FILENO);
+        return dataFileDescriptor;
+    }
+
+    bool writeToFileDescriptor(int fileDescriptor, const string& content) {
+        size_t written = 0;
+        while (written < content.size()) {
+            const ssize_t result = write(fileDescriptor, content.data() + written, content.size() - written);
+            if (result < 0) {
+                if (errno == EINTR) { continue; }
+                return false;
+            }
+            written += result;
+        }
+        return true;
+    }
+
+    vector<string> splitGasFiles(const string& content) {
+        // every gas file written by Garfield starts with this ruler line
+        const string header = "*----.----1----.----2";
+
+        vector<string> files;
+        size_t start = content.find(header);
+        while (start != string::npos) {
+            size_t next = content.find("\n" + header, start);
+            if (next != string::npos) {
+                next++; // keep the newline in the previous file
+            }
+            files.push_back(content.substr(start, next == string::npos ? string::npos : next - start));
+            start = next;
+        }
+        return files;
+    }
+
+    optional<string> selectGasFileElectricFieldValues(const string& content, const vector<size_t>& indices) {
+        vector<string> lines;
+        {
+            istringstream stream(content);
+            for (string line; getline(stream, line);) {
+                lines.push_back(line);
+            }
+        }
+        auto startsWith = [](const string& line, const string& prefix) { return line.compare(0, prefix.size(), prefix) == 0; };
+        auto find = [&](const string& prefix, size_t from = 0) {
+            size_t i = from;
+            while (i < lines.size() && !startsWith(lines[i], prefix)) {
+                i++;
+            }
+            return i;
+        };
+        auto isNumber = [](const string& token) {
+            char* end = nullptr;
+            strtod(token.c_str(), &end);
+            return !token.empty() && *end == '\0';
+        };
+        // numbers of the lines from 'begin' up to the first line which is not only numbers
+        auto readNumbers = [&](size_t begin, size_t& end) {
+            vector<string> numbers;
+            for (end = begin; end < lines.size(); end++) {
+                istringstream stream(lines[end]);
+                vector<string> tokens{istream_iterator<string>(stream), istream_iterator<string>()};
+                if (tokens.empty() || !all_of(tokens.begin(), tokens.end(), isNumber)) {
+                    break;
+                }
+                numbers.insert(numbers.end(), tokens.begin(), tokens.end());
+            }
+            return numbers;
+        };
+        // Garfield writes numbers in columns of 15 characters, 'perLine' per line
+        auto writeNumbers = [](const vector<string>& numbers, size_t perLine) {
+            vector<string> result;
+            ostringstream line;
+            for (size_t i = 0; i < numbers.size(); i++) {
+                line << setw(15) << numbers[i] << " ";
+                if ((i + 1) % perLine == 0 || i + 1 == numbers.size()) {
+                    result.push_back(line.str());
+                    line.str("");
+                }
+            }
+            return result;
+        };
+
+        // ' Dimension : F <electric field values> <angles> <magnetic field values> <excitations> <ionisations>'
+        const size_t dimension = find(" Dimension");
+        if (dimension == lines.size()) {
+            return nullopt;
+        }
+        vector<string> dimensions;
+        {
+            istringstream stream(lines[dimension].substr(lines[dimension].find(':') + 1));
+            dimensions.assign(istream_iterator<string>(stream), istream_iterator<string>());
+        }
+        if (dimensions.size() < 4 || !all_of(dimensions.begin() + 1, dimensions.end(), isNumber)) {
+            return nullopt;
+        }
+        const size_t n = stoul(dimensions[1]);
+        const size_t pointsPerElectricField = stoul(dimensions[2]) * stoul(dimensions[3]);
+        if (n == 0 || pointsPerElectricField == 0 || indices.empty() || !is_sorted(indices.begin(), indices.end()) ||
+            adjacent_find(indices.begin(), indices.end()) != indices.end() || indices.back() >= n) {
+            return nullopt;
+        }
+
+        const size_t fieldsBegin = find(" E fields", dimension) + 1;
+        size_t fieldsEnd = 0;
+        const auto fields = fieldsBegin <= lines.size() ? readNumbers(fieldsBegin, fieldsEnd) : vector<string>();
+        const size_t tablesBegin = find(" The gas tables follow", dimension) + 1;
+        size_t tablesEnd = 0;
+        const auto tables = tablesBegin <= lines.size() ? readNumbers(tablesBegin, tablesEnd) : vector<string>();
+        if (fields.size() != n || tables.empty() || tables.size() % n != 0) {
+            return nullopt;
+        }
+
+        // all the values of an electric field value (for every angle and magnetic field) are written together
+        const size_t valuesPerElectricField = tables.size() / n;
+        vector<string> selectedFields, selectedTables;
+        for (const size_t i: indices) {
+            selectedFields.push_back(fields[i]);
+            selectedTables.insert(selectedTables.end(), tables.begin() + i * valuesPerElectricField, tables.begin() + (i + 1) * valuesPerElectricField);
+        }
+
+        ostringstream dimensionLine;
+        dimensionLine << " Dimension : " << dimensions[0];
+        for (size_t i = 1; i < dimensions.size(); i++) {
+            dimensionLine << " " << setw(9) << (i == 1 ? to_string(indices.size()) : dimensions[i]);
+        }
+
+        vector<string> result(lines.begin(), lines.begin() + dimension);
+        result.push_back(dimensionLine.str());
+        result.insert(result.end(), lines.begin() + dimension + 1, lines.begin() + fieldsBegin);
+        const auto fieldLines = writeNumbers(selectedFields, 5);
+        result.insert(result.end(), fieldLines.begin(), fieldLines.end());
+        result.insert(result.end(), lines.begin() + fieldsEnd, lines.begin() + tablesBegin);
+        const auto tableLines = writeNumbers(selectedTables, 8);
+        result.insert(result.end(), tableLines.begin(), tableLines.end());
+        for (size_t i = tablesEnd; i < lines.size(); i++) {
+            // ' Thresholds: <Townsend> <attachment> <ion dissociation>' are indices of electric field values
+            if (startsWith(lines[i], " Thresholds:")) {
+                istringstream stream(lines[i].substr(lines[i].find(':') + 1));
+                ostringstream line;
+                line << " Thresholds: ";
+                for (size_t threshold; stream >> threshold;) {
+                    const size_t index = lower_bound(indices.begin(), indices.end(), threshold) - indices.begin();
+                    line << setw(10) << min(index, indices.size() - 1);
+                }
+                result.push_back(line.str());
+            } else {
+                result.push_back(lines[i]);
+            }
+        }
+
+        string selected;
+        for (const auto& line: result) {
+            selected += line + "\n";
+        }
+        return selected;
+    }
+
+    TemporaryFile::TemporaryFile(const string& content) {
+        string pattern = (filesystem::temp_directory_path() / "gas-cli-XXXXXX").string();
+        const int fileDescriptor = mkstemp(pattern.data());
+        if (fileDescriptor < 0) {
+            throw runtime_error("could not create temporary file in " + filesystem::temp_directory_path().string());
+        }
+        path = pattern;
+        const bool ok = writeToFileDescriptor(fileDescriptor, content);
+        close(fileDescriptor);
+        if (!ok) {
+            throw runtime_error("could not write temporary file " + path.string());
+        }
+    }
+
+    TemporaryFile::~TemporaryFile() {
+        if (!path.empty()) {
+            error_code ec;
+            filesystem::remove(path, ec);
+        }
+    }
+
+    TemporaryFile::TemporaryFile(TemporaryFile&& other) noexcept : path(std::move(other.path)) {
+        other.path.clear();
+    }
+
+    TemporaryFile& TemporaryFile::operator=(TemporaryFile&& other) noexcept {
+        if (this != &other) {
+            if (!path.empty()) {
+                error_code ec;
+                filesystem::remove(path, ec);
+            }
+            path = std::move(other.path);
+            other.path.clear();
+        }
+        return *this;
+    }
+
     void tar(const std::string& filename, const std::vector<std::string>& files) {
         string command = "tar -czf " + filename;
         for (const auto& file: files) {
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include "Gas.h"
+
+using namespace std;
+
+TEST(Backend, defaultIsMagboltz) {
+    Gas gas;
+    EXPECT_EQ(gas.GetBackend().GetName(), "magboltz");
+}
+
+TEST(Backend, syntheticIsDeterministic) {
+    const vector<double> electricField = {1, 10, 100, 1000};
+
+    auto generate = [](const vector<double>& values, unsigned int seed) {
+        Gas gas({{"Ar", 90}, {"C4H10", 10}});
+        gas.SetBackend(make_shared<SyntheticBackend>(0, 0.01, seed));
+        gas.Generate(values);
+        return gas.GetTable();
+    };
+
+    const auto table = generate(electricField, 1);
+    ASSERT_EQ(table.electricField, electricField);
+    for (const auto& [name, values]: table.GetProperties()) {
+        ASSERT_EQ(values->size(), electricField.size()) << name;
+    }
+    for (const double v: table.electronDriftVelocity) {
+        EXPECT_GT(v, 0);
+    }
+
+    EXPECT_EQ(generate(electricField, 1).electronDriftVelocity, table.electronDriftVelocity);
+    EXPECT_NE(generate(electricField, 2).electronDriftVelocity, table.electronDriftVelocity);
+
+    // values do not depend on which other points are generated together
+    EXPECT_DOUBLE_EQ(generate({100}, 1).electronDriftVelocity.front(), table.electronDriftVelocity[2]);
+}
+
+TEST(Backend, variants) {
+    EXPECT_EQ(generationVariants({}, {}).size(), 1);
+
+    const auto variants = generationVariants({true, false}, {0.3, 0.5});
+    ASSERT_EQ(variants.size(), 4);
+    EXPECT_FALSE(variants[2].thermalMotion);
+    EXPECT_DOUBLE_EQ(variants[3].penningTransferRate, 0.5);
+    EXPECT_EQ(variants[2].GetSuffix(), "thermalOff-penning0.3");
+
+    EXPECT_FALSE(GenerationOptions::FromFilename("ar-90-c4h10-10-nColl10.gas"));
+    for (const auto& variant: variants) {
+        EXPECT_EQ(GenerationOptions::FromFilename("ar-90-c4h10-10-nColl10-" + variant.GetSuffix() + ".gas"), variant);
+        EXPECT_EQ(nlohmann::json(variant).get<GenerationOptions>(), variant);
+    }
+}
+
+TEST(Backend, syntheticOptions) {
+    auto generate = [](const GenerationOptions& options) {
+        Gas gas({{"Ar", 90}, {"C4H10", 10}});
+        auto backend = make_shared<SyntheticBackend>();
+        backend->SetOptions(options);
+        gas.SetBackend(backend);
+        gas.Generate({1000});
+        return gas.GetTable();
+    };
+
+    const auto reference = generate({});
+    EXPECT_LT(generate({false, 0}).electronTransversalDiffusion.front(), reference.electronTransversalDiffusion.front());
+    EXPECT_GT(generate({true, 0.5}).electronTownsend.front(), reference.electronTownsend.front());
+}
+
+TEST(Backend, applyPenningTransfer) {
+    Gas gas({{"Ar", 90}, {"C4H10", 10}});
+    auto backend = make_shared<SyntheticBackend>(0, 0.01);
+    gas.SetBackend(backend);
+    gas.Generate({1000, 5000, 10000});
+    ASSERT_TRUE(gas.ApplyPenningTransfer(0.3));
+
+    Gas reference({{"Ar", 90}, {"C4H10", 10}});
+    backend->SetOptions({true, 0.3});
+    reference.SetBackend(backend);
+    reference.Generate({1000, 5000, 10000});
+
+    const auto table = gas.GetTable(), referenceTable = reference.GetTable();
+    for (size_t i = 0; i < table.electricField.size(); i++) {
+        EXPECT_DOUBLE_EQ(table.electronTownsend[i], referenceTable.electronTownsend[i]);
+        EXPECT_DOUBLE_EQ(table.electronDriftVelocity[i], referenceTable.electronDriftVelocity[i]);
+    }
+}
+
+TEST(Backend, syntheticInvalidParameters) {
+    EXPECT_THROW(SyntheticBackend(0, -0.1), runtime_error);
+    EXPECT_THROW(SyntheticBackend(-1, 0), runtime_error);
+}
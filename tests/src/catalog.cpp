@@ -0,0 +1,114 @@
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <set>
+#include <unistd.h>
+
+#include "Catalog.h"
+#include "Tools.h"
+
+using namespace std;
+using namespace catalog;
+
+Entry makeEntry(const string& file, double argonFraction, double pressure) {
+    Entry entry;
+    entry.file = file;
+    entry.components = {"Ar", "C4H10"};
+    entry.fractions = {argonFraction, 1 - argonFraction};
+    entry.temperature = 20;
+    entry.pressure = pressure;
+    return entry;
+}
+
+TEST(Catalog, numberOfCollisionsFromFilename) {
+    EXPECT_EQ(numberOfCollisionsFromFilename("Ar_98-C4H10_2-T20C-P1bar-nColl10-E1t1000Vcm-nE10log.gas"), 10);
+    EXPECT_EQ(numberOfCollisionsFromFilename("custom.gas"), 0);
+}
+
+TEST(Catalog, nearest) {
+    const vector<Entry> entries = {makeEntry("a.gas", 0.98, 1.0), makeEntry("b.gas", 0.95, 1.0), makeEntry("c.gas", 0.98, 2.0)};
+
+    // components order and fraction units do not matter
+    const Query query{{{"C4H10", 2}, {"Ar", 98}}, 20, 1.0};
+    const auto matches = nearest(entries, query, 2);
+    ASSERT_EQ(matches.size(), 2);
+    EXPECT_EQ(matches[0].second->file, "a.gas");
+    EXPECT_NEAR(matches[0].first, 0, 1E-9);
+    EXPECT_EQ(matches[1].second->file, "b.gas");
+
+    EXPECT_TRUE(nearest(entries, {{{"Ne", 90}, {"CF4", 10}}, 20, 1.0}, 5).empty());
+}
+
+TEST(Catalog, bracket) {
+    const vector<Entry> entries = {makeEntry("p1.gas", 0.98, 1.0), makeEntry("p2.gas", 0.98, 2.0), makeEntry("p4.gas", 0.98, 4.0)};
+
+    const auto result = bracket(entries, {{{"Ar", 98}, {"C4H10", 2}}, 20, 1.5});
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result->a->file, "p2.gas");
+    EXPECT_EQ(result->b->file, "p1.gas");
+    // pressure is interpolated in log scale
+    EXPECT_NEAR(result->weight, log(2.0 / 1.5) / log(2.0), 1E-9);
+    EXPECT_NEAR(result->offLineDistance, 0, 1E-9);
+
+    // nothing on the other side
+    EXPECT_FALSE(bracket(entries, {{{"Ar", 98}, {"C4H10", 2}}, 20, 8.0}));
+}
+
+TEST(Catalog, bracketOnlyAlongSegment) {
+    // the query differs from both entries in fraction, but they only differ in pressure
+    const vector<Entry> entries = {makeEntry("p1.gas", 0.98, 1.0), makeEntry("p2.gas", 0.98, 2.0)};
+    EXPECT_FALSE(bracket(entries, {{{"Ar", 95}, {"C4H10", 5}}, 20, 1.5}));
+
+    // two axes at once: interpolating along the diagonal is fine, a corner is not
+    const vector<Entry> diagonal = {makeEntry("a.gas", 0.98, 1.0), makeEntry("b.gas", 0.96, 2.0)};
+    EXPECT_FALSE(bracket(diagonal, {{{"Ar", 98}, {"C4H10", 2}}, 20, 2.0}));
+}
+
+TEST(Catalog, variants) {
+    auto penning = makeEntry("a-thermalOn-penning0.3.gas", 0.98, 1.0);
+    penning.options = {true, 0.3};
+    auto thermalOff = makeEntry("b-thermalOff-penning0.gas", 0.98, 2.0);
+    thermalOff.options = {false, 0};
+    const vector<Entry> entries = {penning, thermalOff, makeEntry("c.gas", 0.98, 1.0), makeEntry("d.gas", 0.98, 2.0)};
+
+    // variants are not exact matches of a plain query
+    Query query{{{"Ar", 98}, {"C4H10", 2}}, 20, 1.0};
+    const auto matches = nearest(entries, query, 5);
+    ASSERT_EQ(matches.size(), 2);
+    EXPECT_EQ(matches[0].second->file, "c.gas");
+    EXPECT_EQ(matches[1].second->file, "d.gas");
+
+    query.options = {true, 0.3};
+    ASSERT_EQ(nearest(entries, query, 5).size(), 1);
+    EXPECT_EQ(nearest(entries, query, 5).front().second->file, "a-thermalOn-penning0.3.gas");
+
+    // a variant is never paired with a plain table
+    query = {{{"Ar", 98}, {"C4H10", 2}}, 20, 1.5};
+    const auto result = bracket(entries, query);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(set<string>({result->a->file, result->b->file}), set<string>({"c.gas", "d.gas"}));
+    query.options = {false, 0};
+    EXPECT_FALSE(bracket(entries, query));
+}
+
+TEST(Catalog, generationOptionsOfFile) {
+    const auto directory = filesystem::temp_directory_path() / ("gas-catalog-test-" + to_string(getpid()));
+    filesystem::create_directories(directory);
+
+    EXPECT_EQ(generationOptionsOfFile(directory / "a-thermalOff-penning0.3.gas"), GenerationOptions({false, 0.3}));
+    EXPECT_EQ(generationOptionsOfFile(directory / "b.gas"), GenerationOptions());
+    tools::writeToFile((directory / "b.gas.json").string(), R"({"provenance": {"options": {"thermal_motion": false, "penning_transfer_rate": 0.5}}})");
+    EXPECT_EQ(generationOptionsOfFile(directory / "b.gas"), GenerationOptions({false, 0.5}));
+
+    filesystem::remove_all(directory);
+}
+
+TEST(Catalog, entryJson) {
+    auto entry = makeEntry("a.gas", 0.98, 1.0);
+    entry.options = {false, 0.3};
+    EXPECT_EQ(nlohmann::json(entry).get<Entry>().options, entry.options);
+
+    // indexes without options
+    auto j = nlohmann::json(makeEntry("a-thermalOff-penning0.3.gas", 0.98, 1.0));
+    j.erase("options");
+    EXPECT_EQ(j.get<Entry>().options, GenerationOptions({false, 0.3}));
+}
@@ -0,0 +1,34 @@
+#include <gtest/gtest.h>
+
+#include "Export.h"
+#include "Gas.h"
+#include "TableInterpolation.h"
+
+using namespace std;
+
+constexpr double grid[] = {1, 10, 100};
+constexpr double values[] = {2, 20, 30};
+static_assert(gastable::interpolate(grid, values, 5.5) == 11);
+static_assert(gastable::interpolate(grid, values, 0) == 2);
+static_assert(gastable::interpolate(grid, values, 1000) == 30);
+
+TEST(Export, interpolate) {
+    EXPECT_DOUBLE_EQ(gastable::interpolate(grid, values, 55), 25);
+    EXPECT_DOUBLE_EQ(gastable::interpolate(grid, values, 10), 20);
+}
+
+TEST(Export, identifier) {
+    EXPECT_EQ(exporter::identifier("Ar_98-C4H10_2"), "gas_Ar_98_C4H10_2");
+}
+
+TEST(Export, cppHeader) {
+    Gas gas({{"Ar", 90}, {"C4H10", 10}});
+    gas.SetBackend(make_shared<SyntheticBackend>());
+    gas.Generate({1, 10, 100});
+
+    const auto header = exporter::cppHeader(gas, "argon");
+    EXPECT_NE(header.find("namespace argon {"), string::npos);
+    EXPECT_NE(header.find("inline constexpr std::size_t size = 3;"), string::npos);
+    EXPECT_NE(header.find("inline constexpr double electron_drift_velocity[] = {"), string::npos);
+    EXPECT_NE(header.find("constexpr double ElectronDriftVelocity(double electricField)"), string::npos);
+}
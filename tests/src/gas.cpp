@@ -13,3 +13,24 @@ TEST(Gas, defaultValues) {
     EXPECT_DOUBLE_EQ(gas.GetTemperature(), 20.0);
     EXPECT_DOUBLE_EQ(gas.GetPressure(), 1.01324999984); // 1 atm
 }
+
+TEST(Gas, errorReturningFactories) {
+    string error;
+    EXPECT_FALSE(Gas::FromFile("/non/existent/file.gas", &error));
+    EXPECT_FALSE(error.empty());
+
+    error.clear();
+    EXPECT_FALSE(Gas::FromComponents({}, &error));
+    EXPECT_FALSE(error.empty());
+
+    EXPECT_THROW(Gas(vector<pair<string, double>>{}), runtime_error);
+
+    const auto gas = Gas::FromComponents({{"Ar", 90}, {"C4H10", 10}});
+    ASSERT_TRUE(gas);
+    EXPECT_TRUE(gas->GetTableElectricFieldView().empty());
+}
+
+TEST(Gas, tablesNotInGasTable) {
+    const Gas gas({{"Ar", 90}, {"C4H10", 10}});
+    EXPECT_TRUE(gas.GetTablesNotInGasTable().empty());
+}
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <sstream>
+
+#include "Profiler.h"
+
+using namespace std;
+
+namespace {
+    double burn(chrono::milliseconds duration) {
+        const auto end = chrono::steady_clock::now() + duration;
+        volatile double sum = 0;
+        while (chrono::steady_clock::now() < end) {
+            for (int i = 0; i < 1000; i++) {
+                sum = sum + sqrt(double(i));
+            }
+        }
+        return sum;
+    }
+} // namespace
+
+TEST(Profiler, sampling) {
+    ASSERT_TRUE(profiler::start(1000));
+    EXPECT_TRUE(profiler::isRunning());
+    EXPECT_FALSE(profiler::start());
+    burn(chrono::milliseconds(300));
+    profiler::stop();
+    EXPECT_FALSE(profiler::isRunning());
+
+    const size_t samples = profiler::samples();
+    EXPECT_GT(samples, 50);
+    EXPECT_LT(profiler::overhead(), 0.02);
+
+    // every line is 'frame;frame;... <count>' and the counts add up to the number of samples
+    istringstream folded(profiler::foldedStacks());
+    string line;
+    size_t total = 0;
+    while (getline(folded, line)) {
+        const auto separator = line.rfind(' ');
+        ASSERT_NE(separator, string::npos) << line;
+        total += stoul(line.substr(separator + 1));
+    }
+    EXPECT_EQ(total, samples);
+
+    EXPECT_EQ(profiler::summary().rfind("Samples: " + to_string(samples), 0), 0);
+}
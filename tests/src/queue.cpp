@@ -0,0 +1,113 @@
+#include <filesystem>
+#include <gtest/gtest.h>
+
+#include "Queue.h"
+#include "Tools.h"
+
+namespace fs = std::filesystem;
+
+using namespace std;
+
+fs::path makeTemporaryQueue(const string& name) {
+    const auto queue = fs::temp_directory_path() / ("gas-cli-test-" + name);
+    fs::remove_all(queue);
+    return queue;
+}
+
+TEST(Queue, claimEachTaskOnce) {
+    const auto queue = makeTemporaryQueue("claim");
+
+    const auto ids = workqueue::enqueue(queue, {{{"electric_field", 1.0}}, {{"electric_field", 2.0}}});
+    ASSERT_EQ(ids.size(), 2);
+    EXPECT_EQ(workqueue::countPending(queue), 2);
+
+    const auto first = workqueue::claim(queue, "worker");
+    const auto second = workqueue::claim(queue, "worker");
+    ASSERT_TRUE(first);
+    ASSERT_TRUE(second);
+    EXPECT_NE(first->id, second->id);
+    EXPECT_DOUBLE_EQ(first->parameters["electric_field"], 1.0);
+    EXPECT_FALSE(workqueue::claim(queue, "worker"));
+    EXPECT_EQ(workqueue::countClaimed(queue), 2);
+
+    EXPECT_TRUE(workqueue::complete(queue, *first));
+    EXPECT_TRUE(workqueue::release(queue, *second));
+    EXPECT_EQ(workqueue::countDone(queue), 1);
+    EXPECT_EQ(workqueue::countPending(queue), 1);
+
+    // new tasks do not reuse ids
+    const auto moreIds = workqueue::enqueue(queue, {{{"electric_field", 3.0}}});
+    ASSERT_EQ(moreIds.size(), 1);
+    EXPECT_EQ(find(ids.begin(), ids.end(), moreIds.front()), ids.end());
+
+    fs::remove_all(queue);
+}
+
+TEST(Queue, requeueExpired) {
+    const auto queue = makeTemporaryQueue("requeue");
+
+    workqueue::enqueue(queue, {{{"electric_field", 1.0}}});
+    const auto task = workqueue::claim(queue, "worker");
+    ASSERT_TRUE(task);
+
+    EXPECT_EQ(workqueue::requeueExpired(queue, chrono::seconds(3600)), 0);
+    EXPECT_TRUE(workqueue::heartbeat(queue, *task));
+
+    // make the lease look expired
+    fs::last_write_time(queue / "claimed" / (task->id + "." + task->owner + ".json"), fs::file_time_type::clock::now() - chrono::hours(2));
+    EXPECT_EQ(workqueue::requeueExpired(queue, chrono::seconds(3600)), 1);
+    EXPECT_FALSE(workqueue::heartbeat(queue, *task));
+
+    const auto again = workqueue::claim(queue, "worker");
+    ASSERT_TRUE(again);
+    EXPECT_EQ(again->id, task->id);
+
+    // only the current claim can refresh, complete or release the task
+    EXPECT_FALSE(workqueue::heartbeat(queue, *task));
+    EXPECT_FALSE(workqueue::complete(queue, *task));
+    EXPECT_FALSE(workqueue::release(queue, *task));
+    EXPECT_EQ(workqueue::countClaimed(queue), 1);
+    EXPECT_TRUE(workqueue::heartbeat(queue, *again));
+    EXPECT_TRUE(workqueue::complete(queue, *again));
+    EXPECT_EQ(workqueue::countDone(queue), 1);
+
+    fs::remove_all(queue);
+}
+
+TEST(Queue, failedAttempts) {
+    const auto queue = makeTemporaryQueue("failed");
+
+    workqueue::enqueue(queue, {{{"electric_field", 1.0}}});
+    for (unsigned int attempt = 0; attempt < 2; attempt++) {
+        const auto task = workqueue::claim(queue, "worker");
+        ASSERT_TRUE(task);
+        EXPECT_EQ(task->attempts, attempt);
+        EXPECT_FALSE(task->parameters.contains("failed_attempts"));
+        EXPECT_DOUBLE_EQ(task->parameters["electric_field"], 1.0);
+        EXPECT_TRUE(workqueue::fail(queue, *task, 3));
+        EXPECT_FALSE(workqueue::fail(queue, *task, 3));
+        EXPECT_EQ(workqueue::countPending(queue), 1);
+    }
+
+    const auto task = workqueue::claim(queue, "worker");
+    ASSERT_TRUE(task);
+    EXPECT_TRUE(workqueue::fail(queue, *task, 3));
+    EXPECT_EQ(workqueue::countPending(queue), 0);
+    EXPECT_EQ(workqueue::countClaimed(queue), 0);
+    EXPECT_EQ(workqueue::countFailed(queue), 1);
+    EXPECT_FALSE(workqueue::claim(queue, "worker"));
+
+    fs::remove_all(queue);
+}
+
+TEST(Queue, concurrentEnqueue) {
+    const auto queue = makeTemporaryQueue("concurrent");
+    workqueue::enqueue(queue, {});
+
+    const vector<nlohmann::json> tasks(50, {{"electric_field", 1.0}});
+    const auto failed = tools::forkEach(4, 4, [&](size_t) { return workqueue::enqueue(queue, tasks).size() == tasks.size() ? 0 : 1; });
+    EXPECT_TRUE(failed.empty());
+    EXPECT_EQ(workqueue::countPending(queue), 4 * tasks.size());
+
+    fs::remove_all(queue);
+}
@@ -1,6 +1,9 @@
 
+#include <algorithm>
+#include <cmath>
 #include <filesystem>
 #include <gtest/gtest.h>
+#include <random>
 
 #include "Tools.h"
 
@@ -59,3 +62,174 @@ TEST(Tools, removeSimilarElementsTolerance) {
     // ASSERT_NEAR(values.back(), 10000.0, 0.0005);
     ASSERT_NEAR(values.front(), 0.1, 0.0005);
 }
+
+TEST(Tools, compactIndices) {
+    const auto x = linspace<double>(0.0, 10.0, 11);
+    vector<double> linear, kink;
+    for (const auto& value: x) {
+        linear.push_back(2 * value + 1);
+        kink.push_back(value < 5 ? value : 5 + 3 * (value - 5));
+    }
+
+    ASSERT_EQ(compactIndices(x, {linear}, 1E-6), vector<size_t>({0, 10}));
+    const auto kept = compactIndices(x, {linear, kink}, 1E-6);
+    ASSERT_EQ(kept, vector<size_t>({0, 5, 10}));
+    ASSERT_NEAR(maxReconstructionError(x, kink, kept), 0, 1E-12);
+    ASSERT_GT(maxReconstructionError(x, kink, {0, 10}), 0.1);
+}
+
+TEST(Tools, compactIndicesTolerance) {
+    const auto x = logspace<double>(1.0, 1000.0, 100);
+    vector<double> y;
+    for (const auto& value: x) {
+        y.push_back(sqrt(value));
+    }
+
+    const auto kept = compactIndices(x, {y}, 1E-3);
+    ASSERT_LT(kept.size(), x.size());
+    ASSERT_EQ(kept.front(), 0);
+    ASSERT_EQ(kept.back(), x.size() - 1);
+    ASSERT_LE(maxReconstructionError(x, y, kept), 1E-3);
+}
+
+TEST(Tools, findOutliers) {
+    const auto x = logspace<double>(1.0, 1000.0, 40);
+    vector<double> y;
+    for (const auto& value: x) {
+        y.push_back(5 * value / (value + 200));
+    }
+    EXPECT_TRUE(findOutliers(x, y).empty());
+
+    y[10] *= 1.5; // outlier
+    y[25] = 0;    // zeroed point
+    EXPECT_EQ(findOutliers(x, y), vector<size_t>({10, 25}));
+}
+
+TEST(Tools, findOutliersNoisy) {
+    const auto x = logspace<double>(1.0, 1000.0, 100);
+    mt19937 generator(1);
+    normal_distribution<double> noise(1.0, 0.005);
+    vector<double> y;
+    for (const auto& value: x) {
+        y.push_back(5 * value / (value + 200) * noise(generator));
+    }
+    y[50] *= 1.1;
+    EXPECT_EQ(findOutliers(x, y), vector<size_t>({50}));
+}
+
+TEST(Tools, findOutliersCoarse) {
+    // with few points the residuals are mostly fit error and the edges are extrapolations
+    for (const size_t n: {10, 15, 20}) {
+        const auto x = logspace<double>(1.0, 1000.0, n);
+        const auto diffusionField = logspace<double>(10.0, 100000.0, n);
+        vector<double> velocity, diffusion;
+        for (size_t i = 0; i < n; i++) {
+            velocity.push_back(5 * x[i] / (x[i] + 200));
+            diffusion.push_back(0.02 + 0.03 * exp(-diffusionField[i] / 300));
+        }
+        EXPECT_TRUE(findOutliers(x, velocity).empty()) << n << " points";
+        EXPECT_TRUE(findOutliers(diffusionField, diffusion).empty()) << n << " points";
+
+        for (const double factor: {0.7, 1.3, 2.0}) {
+            auto y = velocity;
+            y[n / 2] *= factor;
+            EXPECT_EQ(findOutliers(x, y), vector<size_t>({n / 2})) << n << " points, factor " << factor;
+        }
+    }
+}
+
+TEST(Tools, findOutliersZeroField) {
+    // drift velocity is zero at zero field
+    const auto x = linspace<double>(0.0, 1000.0, 110);
+    vector<double> y;
+    for (const auto& value: x) {
+        y.push_back(5 * value / (value + 200));
+    }
+    EXPECT_TRUE(findOutliers(x, y).empty());
+}
+
+TEST(Tools, findOutliersZeroThenRising) {
+    // Townsend coefficient: zero below threshold
+    const auto x = logspace<double>(1.0, 1000.0, 100);
+    mt19937 generator(1);
+    normal_distribution<double> noise(1.0, 0.005);
+    vector<double> y;
+    for (const auto& value: x) {
+        y.push_back(value < 50 ? 0 : 5 * exp(-500 / value) * noise(generator));
+    }
+    EXPECT_TRUE(findOutliers(x, y).empty());
+
+    y[20] = 0;     // zero among zeros
+    y[70] *= 1.1;  // outlier
+    y[80] = 0;     // zeroed point
+    EXPECT_EQ(findOutliers(x, y), vector<size_t>({70, 80}));
+
+    // attachment coefficient: zero above some field
+    reverse(y.begin(), y.end());
+    for (auto& value: y) {
+        value = value > 0 ? 1 / value : 0;
+    }
+    EXPECT_EQ(findOutliers(x, y), vector<size_t>({19, 29}));
+}
+
+TEST(Tools, forkEach) {
+    const auto failed = forkEach(6, 3, [](size_t i) { return i % 2 == 0 ? 0 : 1; });
+    EXPECT_EQ(failed, vector<size_t>({1, 3, 5}));
+}
+
+TEST(Tools, splitGasFiles) {
+    const string header = "*----.----1----.----2----.----3----.----4----.----5----.----6----.----7----.----8----.----9----.---10----.---11----.---12----.---13--\n";
+    const string first = header + "% Created 01/01/24 at 00.00.00 < none > GAS      \"none\"\n";
+    const string second = header + "% Created 02/01/24 at 00.00.00 < none > GAS      \"none\"\n";
+
+    EXPECT_TRUE(splitGasFiles("").empty());
+    EXPECT_EQ(splitGasFiles(first), vector<string>({first}));
+    EXPECT_EQ(splitGasFiles(first + second), vector<string>({first, second}));
+}
+
+TEST(Tools, selectGasFileElectricFieldValues) {
+    // 4 electric field values, 1 angle, 1 magnetic field value, 3 values per electric field value
+    const string content = "% Created 01/01/24 at 00.00.00 < none > GAS      \"none\"\n"
+                           " Dimension : F         4         1         1         0         0\n"
+                           " E fields   \n"
+                           " 1.00000000E+01  2.00000000E+01  3.00000000E+01  4.00000000E+01 \n"
+                           " E-B angles \n"
+                           " 1.57079633E+00 \n"
+                           " The gas tables follow:\n"
+                           " 1.10000000E+00  1.20000000E+00  1.30000000E+00  2.10000000E+00  2.20000000E+00  2.30000000E+00  3.10000000E+00  3.20000000E+00 \n"
+                           " 3.30000000E+00  4.10000000E+00  4.20000000E+00  4.30000000E+00 \n"
+                           " H Extr:    0    1\n"
+                           " Thresholds:          2         0         3\n";
+
+    const auto selected = selectGasFileElectricFieldValues(content, {0, 3});
+    ASSERT_TRUE(selected);
+    EXPECT_EQ(*selected, "% Created 01/01/24 at 00.00.00 < none > GAS      \"none\"\n"
+                         " Dimension : F         2         1         1         0         0\n"
+                         " E fields   \n"
+                         " 1.00000000E+01  4.00000000E+01 \n"
+                         " E-B angles \n"
+                         " 1.57079633E+00 \n"
+                         " The gas tables follow:\n"
+                         " 1.10000000E+00  1.20000000E+00  1.30000000E+00  4.10000000E+00  4.20000000E+00  4.30000000E+00 \n"
+                         " H Extr:    0    1\n"
+                         " Thresholds:          1         0         1\n");
+
+    EXPECT_FALSE(selectGasFileElectricFieldValues(content, {}));
+    EXPECT_FALSE(selectGasFileElectricFieldValues(content, {2, 1}));
+    EXPECT_FALSE(selectGasFileElectricFieldValues(content, {4}));
+    EXPECT_FALSE(selectGasFileElectricFieldValues("not a gas file", {0}));
+}
+
+TEST(Tools, temporaryFile) {
+    filesystem::path path;
+    {
+        TemporaryFile file("content");
+        path = file.GetPath();
+        EXPECT_EQ(readFile(path), "content");
+
+        TemporaryFile moved(std::move(file));
+        EXPECT_EQ(moved.GetPath(), path);
+        EXPECT_TRUE(filesystem::exists(path));
+    }
+    EXPECT_FALSE(filesystem::exists(path));
+}